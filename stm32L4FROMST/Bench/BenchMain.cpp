@@ -0,0 +1,200 @@
+/*
+ __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : On target benchmark runner (make bench), linked in place of the application main.
+                    Times the Mcu api with the DWT cycle counter and prints one csv line per test on
+                    the debug uart :
+                        BENCH,<name>,<iterations>,<min>,<mean>,<max>   in cycles
+                    between a "BENCH_BEGIN,<SystemCoreClock>" and a "BENCH_END" line.
+                    The flash tests erase and program the page at USERFLASHADRESS : the LoRaWAN
+                    context stored there is lost.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#include "main.h"
+#include "stm32l4xx_hal.h"
+#include "gpio.h"
+#include "lptim.h"
+#include "usart.h"
+#include "spi.h"
+#include "rtc.h"
+#include "ApiMcu.h"
+#include "UserDefine.h"
+#include "McuProfile.h"
+#include "McuVector.h"
+#include "McuPriority.h"
+
+#define BENCH_ITERATIONS       100
+#define BENCH_FLASH_ITERATIONS 10   // each erase wears the page
+#define BENCH_SPI_BURST        16
+#define BENCH_IRQ              TIM7_IRQn  // free vector, pended by software
+
+void SystemClock_Config ( void );
+
+typedef struct {
+    uint32_t Min;
+    uint32_t Max;
+    uint64_t Total;
+    uint32_t Count;
+} BenchResult_t;
+
+static volatile uint32_t BenchIrqCycles;
+
+extern "C" void TIM7_IRQHandler ( void ) {
+    BenchIrqCycles = McuProfileNow ( );
+}
+
+static void BenchReset ( BenchResult_t * result ) {
+    result->Min = 0xFFFFFFFF;
+    result->Max = 0;
+    result->Total = 0;
+    result->Count = 0;
+}
+
+static void BenchAdd ( BenchResult_t * result, uint32_t cycles ) {
+    result->Min = ( cycles < result->Min ) ? cycles : result->Min;
+    result->Max = ( cycles > result->Max ) ? cycles : result->Max;
+    result->Total += cycles;
+    result->Count++;
+}
+
+static void BenchPrint ( const char * name, const BenchResult_t * result ) {
+    mcu.MMprint ( "BENCH,%s,%lu,%lu,%lu,%lu\n", name, ( unsigned long ) result->Count, ( unsigned long ) result->Min,
+                  ( unsigned long ) ( ( result->Count != 0 ) ? result->Total / result->Count : 0 ), ( unsigned long ) result->Max );
+    mcu.TraceFlush ( );
+}
+
+/* cost of two back to back reads of the counter, removed from every measure */
+static uint32_t BenchOverhead ( void ) {
+    uint32_t best = 0xFFFFFFFF;
+    for ( int i = 0; i < BENCH_ITERATIONS; i++ ) {
+        uint32_t start = McuProfileNow ( );
+        uint32_t cycles = McuProfileNow ( ) - start;
+        best = ( cycles < best ) ? cycles : best;
+    }
+    return ( best );
+}
+
+static void BenchSpiBurst ( uint32_t overhead ) {
+    BenchResult_t result;
+    BenchReset ( &result );
+    for ( int i = 0; i < BENCH_ITERATIONS; i++ ) {
+        mcu.SetValueDigitalOutPin ( LORA_CS, 0 );
+        uint32_t start = McuProfileNow ( );
+        for ( int j = 0; j < BENCH_SPI_BURST; j++ ) {
+            mcu.SpiWrite ( 0x1D ); // sx126x ReadRegister : no side effect on the radio
+        }
+        BenchAdd ( &result, McuProfileNow ( ) - start - overhead );
+        mcu.SetValueDigitalOutPin ( LORA_CS, 1 );
+    }
+    BenchPrint ( "spi_burst_16", &result );
+}
+
+static void BenchFlash ( uint32_t overhead ) {
+    BenchResult_t erase, program, store;
+    uint64_t data = 0x0123456789ABCDEFULL;
+    uint8_t context [ 64 ];
+    FLASH_EraseInitTypeDef eraseInit;
+    uint32_t pageError;
+    memset ( context, 0x5A, sizeof ( context ) );
+    eraseInit.TypeErase = FLASH_TYPEERASE_PAGES;
+    eraseInit.Banks     = FLASH_BANK_1;
+    eraseInit.Page      = ( USERFLASHADRESS - FLASH_BASE ) / FLASH_PAGE_SIZE;
+    eraseInit.NbPages   = 1;
+    BenchReset ( &erase );
+    BenchReset ( &program );
+    BenchReset ( &store );
+    for ( int i = 0; i < BENCH_FLASH_ITERATIONS; i++ ) {
+        HAL_FLASH_Unlock ( );
+        uint32_t start = McuProfileNow ( );
+        HAL_FLASHEx_Erase ( &eraseInit, &pageError );
+        BenchAdd ( &erase, McuProfileNow ( ) - start - overhead );
+        start = McuProfileNow ( );
+        HAL_FLASH_Program ( FLASH_TYPEPROGRAM_DOUBLEWORD, USERFLASHADRESS, data );
+        BenchAdd ( &program, McuProfileNow ( ) - start - overhead );
+        HAL_FLASH_Lock ( );
+        start = McuProfileNow ( );
+        mcu.StoreContext ( context, USERFLASHADRESS, sizeof ( context ) / 8 );
+        BenchAdd ( &store, McuProfileNow ( ) - start - overhead );
+    }
+    BenchPrint ( "flash_erase_page", &erase );
+    BenchPrint ( "flash_program_dword", &program );
+    BenchPrint ( "store_context_64", &store );
+}
+
+static void BenchRtc ( uint32_t overhead ) {
+    BenchResult_t result;
+    BenchReset ( &result );
+    for ( int i = 0; i < BENCH_ITERATIONS; i++ ) {
+        uint32_t start = McuProfileNow ( );
+        mcu.RtcGetTimeMs ( );
+        BenchAdd ( &result, McuProfileNow ( ) - start - overhead );
+    }
+    BenchPrint ( "rtc_get_time_ms", &result );
+}
+
+static void BenchPrintf ( uint32_t overhead ) {
+    BenchResult_t result;
+    BenchReset ( &result );
+    for ( int i = 0; i < BENCH_ITERATIONS / 10; i++ ) {
+        uint32_t start = McuProfileNow ( );
+        mcu.MMprint ( "# rx window %d rssi %d snr %d\n", i, -97, 7 );
+        BenchAdd ( &result, McuProfileNow ( ) - start - overhead );
+    }
+    BenchPrint ( "mmprint_32_chars", &result );
+}
+
+/* from the pending write to the first instruction of the handler, then to the return */
+static void BenchIsr ( uint32_t overhead ) {
+    BenchResult_t entry, roundTrip;
+    BenchReset ( &entry );
+    BenchReset ( &roundTrip );
+    HAL_NVIC_SetPriority ( BENCH_IRQ, NVIC_PRIORITY_TIMER, 0 );
+    HAL_NVIC_EnableIRQ ( BENCH_IRQ );
+    for ( int i = 0; i < BENCH_ITERATIONS; i++ ) {
+        uint32_t start = McuProfileNow ( );
+        NVIC->STIR = BENCH_IRQ;
+        __DSB ( );
+        __ISB ( );
+        uint32_t end = McuProfileNow ( );
+        BenchAdd ( &entry, BenchIrqCycles - start - overhead );
+        BenchAdd ( &roundTrip, end - start - overhead );
+    }
+    HAL_NVIC_DisableIRQ ( BENCH_IRQ );
+    BenchPrint ( "isr_entry", &entry );
+    BenchPrint ( "isr_round_trip", &roundTrip );
+}
+
+int main ( void ) {
+    McuVectorInit ( );
+    HAL_Init ( );
+    SystemClock_Config ( );
+    MX_GPIO_Init ( );
+    MX_LPTIM1_Init ( );
+    MX_USART2_UART_Init ( );
+    MX_SPI1_Init ( );
+    MX_RTC_Init ( );
+    McuProfileInit ( );
+
+    uint32_t overhead = BenchOverhead ( );
+    mcu.MMprint ( "BENCH_BEGIN,%lu\n", ( unsigned long ) SystemCoreClock );
+    mcu.MMprint ( "# name,iterations,min,mean,max in cycles, counter overhead %lu removed\n", ( unsigned long ) overhead );
+    BenchSpiBurst ( overhead );
+    BenchFlash ( overhead );
+    BenchRtc ( overhead );
+    BenchPrintf ( overhead );
+    BenchIsr ( overhead );
+    mcu.MMprint ( "BENCH_END\n" );
+    mcu.TraceFlush ( );
+    while ( 1 ) {
+        __WFI ( );
+    }
+}
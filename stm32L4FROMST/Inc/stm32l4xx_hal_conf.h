@@ -67,7 +67,7 @@
 /*#define HAL_HASH_MODULE_ENABLED   */
 /*#define HAL_I2S_MODULE_ENABLED   */
 /*#define HAL_IRDA_MODULE_ENABLED   */
-#define HAL_IWDG_MODULE_ENABLED   */
+#define HAL_IWDG_MODULE_ENABLED
 /*#define HAL_LTDC_MODULE_ENABLED   */
 /*#define HAL_LCD_MODULE_ENABLED   */
 #define HAL_LPTIM_MODULE_ENABLED
@@ -192,7 +192,7 @@
   */     
   
 #define  VDD_VALUE					  ((uint32_t)3300U) /*!< Value of VDD in mv */           
-#define  TICK_INT_PRIORITY            ((uint32_t)0U)    /*!< tick interrupt priority */            
+#define  TICK_INT_PRIORITY            ((uint32_t)4U)    /*!< tick interrupt priority, NVIC_PRIORITY_SYSTICK in McuPriority.h */            
 #define  USE_RTOS                     0U     
 #define  PREFETCH_ENABLE              0U
 #define  INSTRUCTION_CACHE_ENABLE     1U
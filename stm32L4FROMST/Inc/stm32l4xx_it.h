@@ -56,11 +56,19 @@ void SVC_Handler(void);
 void DebugMon_Handler(void);
 void PendSV_Handler(void);
 void SysTick_Handler(void);
+void WWDG_IRQHandler(void);
 void RTC_WKUP_IRQHandler(void);
 void I2C1_EV_IRQHandler(void);
-void EXTI15_10_IRQHandler(void);
 void LPTIM1_IRQHandler(void);
+void EXTI0_IRQHandler(void);
+void EXTI1_IRQHandler(void);
+void EXTI2_IRQHandler(void);
 void EXTI3_IRQHandler(void);
+void EXTI4_IRQHandler(void);
+void EXTI9_5_IRQHandler(void);
+void EXTI15_10_IRQHandler(void);
+void DMA1_Channel6_IRQHandler(void);
+void USART2_IRQHandler(void);
 #ifdef __cplusplus
 }
 #endif
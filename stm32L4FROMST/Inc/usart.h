@@ -52,6 +52,7 @@
 /* USER CODE END Includes */
 
 extern UART_HandleTypeDef huart2;
+extern DMA_HandleTypeDef hdma_usart2_rx;
 
 /* USER CODE BEGIN Private defines */
 
@@ -62,6 +63,7 @@ extern UART_HandleTypeDef huart2;
 void MX_USART2_UART_Init(void);
 
 /* USER CODE BEGIN Prototypes */
+HAL_StatusTypeDef MX_USART2_SetBaudRate(uint32_t BaudRate);
 
 /* USER CODE END Prototypes */
 
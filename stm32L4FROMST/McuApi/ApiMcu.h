@@ -9,7 +9,8 @@
                                                    
                                                    
 Description       : Mcu Api. 
-                    To implement a new mcu , contributor have to create a new mcu class with the same prototype as McuXX class 
+                    To implement a new mcu , contributor have to create a new mcu class providing the methods
+                    checked by McuXX, a missing or mistyped method is reported at compile time.
 
 
 License           : Revised BSD License, see LICENSE.TXT file include in the project
@@ -20,211 +21,97 @@ Maintainer        : Fabien Holin (SEMTECH)
 #define MCUXX_H
 
 
-#include "ClassSTM32L4.h"
+#if defined ( MCU_POSIX )
+    #include "ClassPosix.h"
+    typedef McuPosix McuTarget;   // host simulation, see ClassPosix.h
+#elif defined ( MCU_STM32L0 )
+    #include "ClassSTM32L0.h"
+    typedef McuSTM32L0 McuTarget;
+#else
+    #include "ClassSTM32L4.h"
+    typedef McuSTM32L4 McuTarget;
+#endif
+#include "UserBoard.h"
 #include <string.h>
+#include <type_traits>
+
+/*!
+ * MCU_API_METHOD : McuApiHas<name> < R >::value is true if the class R has the method name with this signature
+ * \remark an overloaded method is checked once per signature, MCU_API_METHOD_AS names the trait
+ */
+#define MCU_API_METHOD_AS( trait, name, ret, ... )                                                              \
+    template < class R, class = void > struct McuApiHas##trait : std::false_type { };                          \
+    template < class R > struct McuApiHas##trait < R,                                                           \
+        decltype ( ( void ) static_cast < ret ( R::* ) ( __VA_ARGS__ ) > ( &R::name ) ) > : std::true_type { };
+#define MCU_API_METHOD( name, ret, ... ) MCU_API_METHOD_AS ( name, name, ret, __VA_ARGS__ )
+
+MCU_API_METHOD    ( InitMcu,                void,     void )
+MCU_API_METHOD    ( InitSpi,                void,     void )
+MCU_API_METHOD    ( SpiWrite,               uint8_t,  int )
+MCU_API_METHOD    ( RestoreContext,         int,      uint8_t *, uint32_t, uint32_t )
+MCU_API_METHOD    ( StoreContext,           int,      const void *, uint32_t, uint32_t )
+MCU_API_METHOD    ( WriteFlashWithoutErase, int,      uint8_t *, uint32_t, uint32_t )
+MCU_API_METHOD    ( RtcInit,                void,     void )
+MCU_API_METHOD    ( RtcGetTimeSecond,       uint32_t, void )
+MCU_API_METHOD    ( RtcGetTimeMs,           uint32_t, void )
+MCU_API_METHOD    ( GotoSleepSecond,        void,     int )
+MCU_API_METHOD    ( GotoSleepMSecond,       void,     int )
+MCU_API_METHOD    ( WatchDogStart,          void,     void )
+MCU_API_METHOD    ( WatchDogRelease,        void,     void )
+MCU_API_METHOD    ( WatchDogRegister,       int,      const char *, uint32_t )
+MCU_API_METHOD    ( WatchDogCheckIn,        void,     int )
+MCU_API_METHOD    ( LowPowerTimerLoRaInit,  void,     void )
+MCU_API_METHOD    ( StartTimerMsecond,      void,     void ( * ) ( void * ), void *, int )
+MCU_API_METHOD    ( timerISR,               void,     void )
+MCU_API_METHOD    ( SetValueDigitalOutPin,  void,     PinName, int )
+MCU_API_METHOD    ( GetValueDigitalInPin,   int,      PinName )
+MCU_API_METHOD_AS ( AttachInterruptInObj,   AttachInterruptIn, void, void ( * ) ( void * ), void * )
+MCU_API_METHOD_AS ( AttachInterruptInVoid,  AttachInterruptIn, void, void ( * ) ( void ) )
+MCU_API_METHOD    ( ExtISR,                 void,     void )
+MCU_API_METHOD    ( MMprint,                void,     const char *, ... )
+MCU_API_METHOD    ( GetUniqueId,            void,     uint8_t * )
+
+/*!
+ * McuXX : the Mcu api used by the LoRaWAN stack and the application, implemented by the class R
+ * \remark R is bound at compile time : the calls are direct, the methods defined in the class
+ *         R declaration (SpiWrite, SetValueDigitalOutPin ...) are inlined in the callers
+ * \remark a new mcu class has to provide every method checked below, see ClassSTM32L4.h and McuCore.h for their
+ *         documentation, the STM32 families share McuCore
+ */
 template < class R >
     class McuXX : public R{
 public :    
     McuXX ( PinName mosi, PinName miso, PinName sclk ):R (mosi,miso,sclk){};
     ~McuXX ( ){};
-//    void InitMcu ( void );
-///******************************************************************************/
-///*                                Mcu Spi Api                                 */
-///******************************************************************************/
-//    /** Create a SPI master connected to the specified pins
-//    *
-//    *  @param mosi SPI Master Out, Slave In pin
-//    *  @param miso SPI Master In, Slave Out pin
-//    *  @param sclk SPI Clock pin
-//    */
-//    void InitSpi ( );
-//    /** Write to the SPI Slave and return the response
-//    *
-//    *  @param value Data to be sent to the SPI slave
-//    *
-//    *  @returns
-//    *    Response from the SPI slave
-//    */
-//    uint8_t SpiWrite(int value);
-//    
-//    /** Configure the data transmission format
-//    *
-//    *  @param bits Number of bits per SPI frame (4 - 16)
-//    *  @param mode Clock polarity and phase mode (0 - 3)
-//    *
-//    * @code
-//    * mode | POL PHA
-//    * -----+--------
-//    *   0  |  0   0
-//    *   1  |  0   1
-//    *   2  |  1   0
-//    *   3  |  1   1
-//    * @endcode
-//    */
-//    void Spiformat(int bits, int mode = 0) { } ;
-//        
-//    /** Set the spi bus clock frequency
-//    *
-//    *  @param hz SCLK frequency in hz (default = 1MHz)
-//    */
-//    void SetSpiFrequency(int hz = 1000000) { } ;
-//    PinName McuMosi;
-//    PinName McuMiso;
-//    PinName McuSclk;
-
-///******************************************************************************/
-///*                                Mcu Flash Api                               */
-///******************************************************************************/
-//     /** RestoreContext data from a flash device.  
-//     * 
-//     *  This method invokes memcpy - reads number of bytes from the address 
-//     * 
-//     *  @param buffer Buffer to write to 
-//     *  @param addr   Flash address to begin reading from 
-//     *  @param size   Size to read in bytes 
-//     *  @return       0 on success, negative error code on failure 
-//     */ 
-//    int RestoreContext(uint8_t *buffer, uint32_t addr, uint32_t size);
-
-// 
-//    /** StoreContext data to flash
-//     *  To be safer this function have to implement a read/check data sequence after programation 
-//     *  
-//     * 
-//     *  @param buffer Buffer of data to be written 
-//     *  @param addr   Flash Address to begin writing to,
-//     *  @param size   Size to write in bytes,
-//     *  @return       0 on success, negative error code on failure 
-//     */ 
-//    int StoreContext(const void *buffer, uint32_t addr, uint32_t size); 
-//    
-///******************************************************************************/
-///*                                Mcu RTC Api                                 */
-///******************************************************************************/
-//    /*!
-//    * RtcInit Function
-//    * \remark must be called before any call to initiliaze the timers
-//    * \param [IN]   void
-//    * \param [OUT]  void       
-//    */
-//    void     RtcInit            ( void ) ;
-//    
-//    /*!
-//    * RtcGetTimeSecond : return the Current Rtc time in Second 
-//    * \remark is used for :
-//    * \remark scheduling autonomous retransmissions (for exemple NbTrans) , transmitting MAC answers , basically any delay without accurate time constraints
-//    * \remark also used to measure the time spent inside the LoRaWAN process for the integrated failsafe
-//    * \param [IN]   void
-//    * \param [OUT]  uint32_t RTC time in Second       
-//    */
-//    uint32_t RtcGetTimeSecond       ( void ) ;
-//   /*!
-//    * RtcGetTimeMs : return the Current Rtc time in Ms 
-//    * \remark is used to timestamp radio events (end of TX), will also be used for future classB
-//    * \remark this function may be used by the application.
-//    * \param [IN]   void
-//    * \param [OUT]  uint32_t Current RTC time in ms wraps every 49 days       
-//    */
-//    uint32_t RtcGetTimeMs  ( void ) ;
-//    
-///******************************************************************************/
-///*                                Mcu Sleep Api                               */
-///******************************************************************************/
-//    /*!
-//    * A function to set the mcu in low power mode  for duration seconds
-//    * \remark inside this function watchdog has to be manage to not reset the mcu
-//    * \param [IN]   int delay 
-//    * \param [OUT]  void       
-//    */
-//    void GotoSleepSecond (int duration ) ;
-//    
-//        /*!
-//    * A function to set the mcu in low power mode  for duration in milliseconds
-//    * \remark 
-//    * \param [IN]   int delay 
-//    * \param [OUT]  void       
-//    */
-//    void     GotoSleepMSecond   ( int delay );
-//    
-///******************************************************************************/
-///*                             Mcu WatchDog Api                               */
-///******************************************************************************/
-//    /* A function to init and start the Watchdog 
-//    * \remark The expired period = WATCH_DOG_PERIOD_RELEASE seconds
-//    * \param [IN]   void  
-//    * \param [OUT]  void       
-//    */
-//    void WatchDogStart ( void ) ;
-
-//    /* A function to release the Watchdog 
-//    * \remark Application have to call this function periodically (with a period <WATCH_DOG_PERIOD_RELEASE)
-//    *         If not , the mcu will reset.
-//    * \param [IN]   void  
-//    * \param [OUT]  void       
-//    */
-//    void WatchDogRelease ( void ) ;
-//    
-//    
-///******************************************************************************/
-///*                             Mcu WatchDog Api                               */
-///******************************************************************************/
-///*!
-//    * LowPowerTimerLoRa Init
-//    *\remark initializes the dedicated LoRaWAN low power timer object. MCU specific.
-//    * \param [IN]  void
-//    * \param [OUT] void         
-//    */
-//    void LowPowerTimerLoRaInit ( void );
-//    /*!
-//    * LowPowerTimerLoRa AttachMsecond
-//    *
-//    * \param void (* _Func) (void *) a static method member of the current Obj
-//    * \param *_obj a pointer to the current objet
-//    * \param int delay in ms delay should be between 1ms and 16s.
-//    * \param [OUT] void         
-//    * \remark the code  Func =  _Func ; and obj  = _obj; isn't mcu dependent , and could be keep as already implemented
-//    * \remark starts the LoRaWAN dedicated timer and attaches the IRQ to the handling Interupt Service Routine in the LoRaWAN object.
-//    */
-//    void StartTimerMsecond     ( void (* _Func) (void *) , void * _obj, int delay) ;
-//        
-//    /*!
-//    *  timerISR
-//    * \remark    Do Not Modify 
-//    */
-//    void timerISR              ( void ) { Func(obj); };
-
-///******************************************************************************/
-///*                           Mcu Gpio Api                                     */
-///******************************************************************************/
-//    void SetValueDigitalOutPin ( PinName Pin, int Value );
-//    int  GetValueDigitalInPin  ( PinName Pin );
-//    void AttachInterruptIn     (  void (* _Funcext) (void *) , void * _objext) ;
-//    void AttachInterruptIn     (  void (* _Funcext) ( void ) ) { _UserFuncext = _Funcext; userIt = 1 ; };
-//    void DetachInterruptIn     (  void (* _Funcext) ( void ) ) { userIt = 0 ; };
-//    /*!
-//    *  ExtISR
-//    * \remark    Do Not Modify 
-//    */
-//    void ExtISR                ( void ) { if (userIt == 0 ) { Funcext(objext); } else { _UserFuncext ();}; };
-//    
-///******************************************************************************/
-///*                           Mcu wait                                         */
-///******************************************************************************/   
-////    void mwait   (uint16_t value) { wait ( value );};
-////    void mwait_ms (uint32_t value){ wait_ms ( value );};
-//private :
-//    /*!
-//    *  Low power timer
-//    * \remark    Do Not Modify 
-//    */
-//    static void DoNothing (void *) { };
-//    void (* Func) (void *);
-//    void * obj;
-//    void (* Funcext) (void *);
-//    void * objext;
-//    void (* _UserFuncext) ( void );
-//    int userIt;
+private :
+    static_assert ( McuApiHasInitMcu < R >::value,                "the mcu class has to implement void InitMcu ( void )" );
+    static_assert ( McuApiHasInitSpi < R >::value,                "the mcu class has to implement void InitSpi ( void )" );
+    static_assert ( McuApiHasSpiWrite < R >::value,               "the mcu class has to implement uint8_t SpiWrite ( int )" );
+    static_assert ( McuApiHasRestoreContext < R >::value,         "the mcu class has to implement int RestoreContext ( uint8_t *, uint32_t, uint32_t )" );
+    static_assert ( McuApiHasStoreContext < R >::value,           "the mcu class has to implement int StoreContext ( const void *, uint32_t, uint32_t )" );
+    static_assert ( McuApiHasWriteFlashWithoutErase < R >::value, "the mcu class has to implement int WriteFlashWithoutErase ( uint8_t *, uint32_t, uint32_t )" );
+    static_assert ( McuApiHasRtcInit < R >::value,                "the mcu class has to implement void RtcInit ( void )" );
+    static_assert ( McuApiHasRtcGetTimeSecond < R >::value,       "the mcu class has to implement uint32_t RtcGetTimeSecond ( void )" );
+    static_assert ( McuApiHasRtcGetTimeMs < R >::value,           "the mcu class has to implement uint32_t RtcGetTimeMs ( void )" );
+    static_assert ( McuApiHasGotoSleepSecond < R >::value,        "the mcu class has to implement void GotoSleepSecond ( int )" );
+    static_assert ( McuApiHasGotoSleepMSecond < R >::value,       "the mcu class has to implement void GotoSleepMSecond ( int )" );
+    static_assert ( McuApiHasWatchDogStart < R >::value,          "the mcu class has to implement void WatchDogStart ( void )" );
+    static_assert ( McuApiHasWatchDogRelease < R >::value,        "the mcu class has to implement void WatchDogRelease ( void )" );
+    static_assert ( McuApiHasWatchDogRegister < R >::value,       "the mcu class has to implement int WatchDogRegister ( const char *, uint32_t )" );
+    static_assert ( McuApiHasWatchDogCheckIn < R >::value,        "the mcu class has to implement void WatchDogCheckIn ( int )" );
+    static_assert ( McuApiHasLowPowerTimerLoRaInit < R >::value,  "the mcu class has to implement void LowPowerTimerLoRaInit ( void )" );
+    static_assert ( McuApiHasStartTimerMsecond < R >::value,      "the mcu class has to implement void StartTimerMsecond ( void ( * ) ( void * ), void *, int )" );
+    static_assert ( McuApiHastimerISR < R >::value,               "the mcu class has to implement void timerISR ( void )" );
+    static_assert ( McuApiHasSetValueDigitalOutPin < R >::value,  "the mcu class has to implement void SetValueDigitalOutPin ( PinName, int )" );
+    static_assert ( McuApiHasGetValueDigitalInPin < R >::value,   "the mcu class has to implement int GetValueDigitalInPin ( PinName )" );
+    static_assert ( McuApiHasAttachInterruptInObj < R >::value,   "the mcu class has to implement void AttachInterruptIn ( void ( * ) ( void * ), void * )" );
+    static_assert ( McuApiHasAttachInterruptInVoid < R >::value,  "the mcu class has to implement void AttachInterruptIn ( void ( * ) ( void ) )" );
+    static_assert ( McuApiHasExtISR < R >::value,                 "the mcu class has to implement void ExtISR ( void )" );
+    static_assert ( McuApiHasMMprint < R >::value,                "the mcu class has to implement void MMprint ( const char *, ... )" );
+    static_assert ( McuApiHasGetUniqueId < R >::value,            "the mcu class has to implement void GetUniqueId ( uint8_t DevEui [ 8 ] )" );
 };
+#if !defined ( MCU_POSIX ) && !defined ( MCU_STM32L0 )
 HAL_StatusTypeDef FLASH_If_BankSwitch(void);
-extern McuXX<McuSTM32L4> mcu;
+#endif
+extern McuXX<McuTarget> mcu;
 #endif
@@ -0,0 +1,750 @@
+/*
+ __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Host simulation MCU.
+
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#include "ClassPosix.h"
+#include "ApiMcu.h"
+#include "UserDefine.h"
+#include "McuTrace.h"
+#include "McuLog.h"
+#include "McuWatchDog.h"
+#include "McuProfile.h"
+#include "McuPool.h"
+#include "McuTask.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+typedef std::chrono::steady_clock PosixClock;
+
+typedef struct {
+    uint64_t DueUs;
+    void  (* Func) ( void * );   // NULL when the slot is free
+    void *   Ctx;
+} PosixEvent_t;
+
+typedef struct {
+    const char * Name;
+    uint32_t     TimeoutMs;
+    uint32_t     LastCheckInMs;
+    int32_t      MarginMinMs;  // smallest timeout - delay since the check in, seen by WatchDogRelease
+    int          Thread;       // last check in out of a handler, suspended while GotoSleepSecond sleeps
+} PosixWatchDogTask_t;
+
+typedef struct {
+    uint32_t     TimerNumber;
+    int64_t      TimerDriftUs;        // sum of the fired time - requested time
+    int32_t      TimerDriftMinUs;
+    int32_t      TimerDriftMaxUs;
+    uint32_t     TimerLost;           // restarted before it fired
+    uint32_t     TimerTruncated;      // more ticks than the 16 bits compare register
+    uint32_t     IrqNumber;
+    uint32_t     IrqLate;             // run more than POSIX_DEADLINE_US after their due time
+    uint32_t     IrqLateMaxUs;
+    uint32_t     WatchDogReleases;
+    uint32_t     WatchDogRefused;     // a task missed its check in
+    uint32_t     WatchDogMarginMinMs; // smallest time left before the IWDG expiry when released
+    uint64_t     FlashProgrammed;     // bytes
+    uint64_t     FlashErased;
+} PosixStats_t;
+
+static std::recursive_mutex      IrqMutex;      // simulated PRIMASK
+static std::mutex                ClockMutex;    // virtual clock, timers and events
+static std::condition_variable   ClockChanged;  // a timer was armed, an interrupt ran or the scale changed
+static PosixClock::time_point    RealBase;
+static uint64_t                  VirtualBaseUs = 0;
+static double                    TimeScale = 0;
+static int                       Discrete = 1;  // VirtualBaseUs is the time, moved by the sleeps and the calls
+static int                       InIrq = 0;
+static uint64_t                  IrqCount = 0;
+static int                       IrqThreadStarted = 0;
+static PosixStats_t              Stats;
+
+static uint64_t                  TimerDueUs = 0;
+static uint64_t                  TimerRequestedUs = 0;
+static int                       TimerArmed = 0;
+static PosixEvent_t              Events [ POSIX_MAX_EVENTS ];
+static uint64_t                  IwdgDueUs = 0;
+static int                       IwdgStarted = 0;
+static PosixWatchDogTask_t       WatchDogTasks [ WATCH_DOG_MAX_TASKS ];
+static int                       WatchDogTaskNumber = 0;
+static const char *              WatchDogLate = NULL;
+static int                       WatchDogSleeping = 0;
+
+static uint8_t                   FlashImage [ POSIX_FLASH_SIZE ];
+static FILE *                    FlashFile = NULL;
+static uint8_t                   PinLevel [ 256 ];
+static void                   (* UartHook ) ( const uint8_t * data, uint32_t length ) = NULL;
+
+/******************************************************************************/
+/*                       Virtual clock and interrupt thread                   */
+/******************************************************************************/
+void McuPosixIrqLock ( void ) {
+    IrqMutex.lock ( );
+}
+
+void McuPosixIrqUnlock ( void ) {
+    IrqMutex.unlock ( );
+}
+
+static uint64_t PosixNowUsLocked ( void ) {
+    if ( Discrete != 0 ) {
+        return ( VirtualBaseUs );
+    }
+    double elapsedUs = std::chrono::duration < double, std::micro > ( PosixClock::now ( ) - RealBase ).count ( );
+    return ( VirtualBaseUs + ( uint64_t ) ( elapsedUs * TimeScale ) );
+}
+
+static PosixClock::time_point PosixRealDeadline ( uint64_t dueUs ) {
+    double realUs = ( dueUs > VirtualBaseUs ) ? ( double ) ( dueUs - VirtualBaseUs ) / TimeScale : 0;
+    return ( RealBase + std::chrono::duration_cast < PosixClock::duration > ( std::chrono::duration < double, std::micro > ( realUs ) ) );
+}
+
+uint64_t McuPosixNowUs ( void ) {
+    std::lock_guard < std::mutex > lock ( ClockMutex );
+    return ( PosixNowUsLocked ( ) );
+}
+
+void McuPosixUartWrite ( const uint8_t * data, uint32_t length ) {
+    if ( UartHook != NULL ) {
+        UartHook ( data, length );
+    } else {
+        fwrite ( data, 1, length, stdout );
+    }
+}
+
+static void PosixTimerIrq ( void * ) {
+    int32_t drift = ( int32_t ) ( McuPosixNowUs ( ) - TimerRequestedUs );
+    if ( ( Stats.TimerNumber == 0 ) || ( drift < Stats.TimerDriftMinUs ) ) {
+        Stats.TimerDriftMinUs = drift;
+    }
+    if ( ( Stats.TimerNumber == 0 ) || ( drift > Stats.TimerDriftMaxUs ) ) {
+        Stats.TimerDriftMaxUs = drift;
+    }
+    Stats.TimerDriftUs += drift;
+    Stats.TimerNumber++;
+    mcu.timerISR ( );
+}
+
+static void PosixIwdgExpired ( void * ) {
+    fflush ( stdout );
+    fprintf ( stderr, "IWDG reset at %lu ms, late task %s\n", ( unsigned long ) ( McuPosixNowUs ( ) / 1000 ),
+              ( WatchDogLate != NULL ) ? WatchDogLate : "none" );
+    _Exit ( 3 );
+}
+
+/* the earliest of the lptim timer, the posted events and the iwdg, ClockMutex held */
+static uint64_t PosixNextIrq ( void (** func) ( void * ), void ** ctx, int * slot ) {
+    uint64_t due = UINT64_MAX;
+    *func = NULL;
+    *slot = -1;
+    if ( ( TimerArmed != 0 ) && ( TimerDueUs < due ) ) {
+        due   = TimerDueUs;
+        *func = PosixTimerIrq;
+    }
+    for ( int i = 0; i < POSIX_MAX_EVENTS; i++ ) {
+        if ( ( Events [ i ].Func != NULL ) && ( Events [ i ].DueUs < due ) ) {
+            due   = Events [ i ].DueUs;
+            *func = Events [ i ].Func;
+            *ctx  = Events [ i ].Ctx;
+            *slot = i;
+        }
+    }
+    if ( ( IwdgStarted != 0 ) && ( IwdgDueUs < due ) ) {
+        due   = IwdgDueUs;
+        *func = PosixIwdgExpired;
+        *slot = -1;
+    }
+    return ( due );
+}
+
+/* take the interrupt out of its slot, ClockMutex held */
+static void PosixClearIrq ( void (* func) ( void * ), int slot ) {
+    if ( func == PosixTimerIrq ) {
+        TimerArmed = 0;
+    } else if ( slot >= 0 ) {
+        Events [ slot ].Func = NULL;
+    }
+}
+
+/* run an interrupt handler with the simulated PRIMASK, ClockMutex released */
+static void PosixRunIrq ( void (* func) ( void * ), void * ctx, uint64_t due ) {
+    McuPosixIrqLock ( );
+    uint64_t late = McuPosixNowUs ( ) - due;
+    if ( late > POSIX_DEADLINE_US ) {
+        Stats.IrqLate++;
+    }
+    if ( late > Stats.IrqLateMaxUs ) {
+        Stats.IrqLateMaxUs = ( uint32_t ) late;
+    }
+    Stats.IrqNumber++;
+    InIrq = 1;
+    func ( ctx );
+    InIrq = 0;
+    McuPosixIrqUnlock ( );
+    std::lock_guard < std::mutex > lock ( ClockMutex );
+    IrqCount++;
+    ClockChanged.notify_all ( );
+}
+
+static void PosixIrqThread ( void ) {
+    std::unique_lock < std::mutex > lock ( ClockMutex );
+    for ( ;; ) {
+        void ( * func ) ( void * ) = NULL;
+        void * ctx = NULL;
+        int slot;
+        uint64_t due = PosixNextIrq ( &func, &ctx, &slot );
+        if ( ( Discrete != 0 ) || ( func == NULL ) ) {
+            ClockChanged.wait ( lock );
+            continue;
+        }
+        if ( due > PosixNowUsLocked ( ) ) {
+            ClockChanged.wait_until ( lock, PosixRealDeadline ( due ) );
+            continue; // something may have been armed meanwhile
+        }
+        PosixClearIrq ( func, slot );
+        lock.unlock ( );
+        PosixRunIrq ( func, ctx, due );
+        lock.lock ( );
+    }
+}
+
+/* discrete event : move the time up to untilUs, running the interrupts due on the way */
+static void PosixDiscreteRun ( uint64_t untilUs, int wakeOnIrq ) {
+    for ( ;; ) {
+        void ( * func ) ( void * ) = NULL;
+        void * ctx = NULL;
+        int slot;
+        std::unique_lock < std::mutex > lock ( ClockMutex );
+        uint64_t due = PosixNextIrq ( &func, &ctx, &slot );
+        if ( ( func == NULL ) || ( due > untilUs ) ) {
+            if ( untilUs > VirtualBaseUs ) {
+                VirtualBaseUs = untilUs;
+            }
+            return;
+        }
+        if ( due > VirtualBaseUs ) {
+            VirtualBaseUs = due;
+        }
+        PosixClearIrq ( func, slot );
+        lock.unlock ( );
+        PosixRunIrq ( func, ctx, due );
+        if ( wakeOnIrq != 0 ) {
+            return;
+        }
+    }
+}
+
+/* discrete event : an Mcu api call takes POSIX_CALL_COST_US, the pending interrupts may run */
+static void PosixCallCost ( void ) {
+    if ( ( Discrete != 0 ) && ( InIrq == 0 ) ) {
+        PosixDiscreteRun ( McuPosixNowUs ( ) + POSIX_CALL_COST_US, 0 );
+    }
+}
+
+/* wait on the virtual clock, a simulated interrupt ends the wait when wakeOnIrq is set */
+static void PosixSleepUs ( uint64_t durationUs, int wakeOnIrq ) {
+    if ( Discrete != 0 ) {
+        if ( InIrq == 0 ) {
+            PosixDiscreteRun ( McuPosixNowUs ( ) + durationUs, wakeOnIrq );
+        } else {
+            std::lock_guard < std::mutex > lock ( ClockMutex );
+            VirtualBaseUs += durationUs; // a wait inside a handler holds the other interrupts off
+        }
+        return;
+    }
+    std::unique_lock < std::mutex > lock ( ClockMutex );
+    uint64_t due = PosixNowUsLocked ( ) + durationUs;
+    uint64_t irqCount = IrqCount;
+    while ( ( PosixNowUsLocked ( ) < due ) && ( ( wakeOnIrq == 0 ) || ( irqCount == IrqCount ) ) ) {
+        ClockChanged.wait_until ( lock, PosixRealDeadline ( due ) );
+    }
+}
+
+void McuPosixIdle ( uint64_t maxUs ) {
+    PosixSleepUs ( maxUs, 1 );
+}
+
+void McuPosixResetStats ( void ) {
+    McuPosixIrqLock ( );
+    memset ( &Stats, 0, sizeof ( Stats ) );
+    Stats.WatchDogMarginMinMs = POSIX_IWDG_PERIOD_MS;
+    for ( int i = 0; i < WatchDogTaskNumber; i++ ) {
+        WatchDogTasks [ i ].MarginMinMs = ( int32_t ) WatchDogTasks [ i ].TimeoutMs;
+    }
+    McuPosixIrqUnlock ( );
+}
+
+void McuPosixFlashCounters ( uint64_t * programmed, uint64_t * erased ) {
+    *programmed = Stats.FlashProgrammed;
+    *erased     = Stats.FlashErased;
+}
+
+void McuPosixPrint ( void ) {
+    PosixStats_t stats = Stats;
+    uint64_t now = McuPosixNowUs ( );
+    mcu.MMprint ( "virtual time %lu.%03lu s, %s clock\n", ( unsigned long ) ( now / 1000000 ), ( unsigned long ) ( ( now / 1000 ) % 1000 ),
+                  ( Discrete != 0 ) ? "discrete event" : "scaled" );
+    mcu.MMprint ( "timer %lu fired, drift mean %ld us min %ld max %ld, %lu lost, %lu truncated\n", ( unsigned long ) stats.TimerNumber,
+                  ( long ) ( ( stats.TimerNumber != 0 ) ? stats.TimerDriftUs / stats.TimerNumber : 0 ),
+                  ( long ) stats.TimerDriftMinUs, ( long ) stats.TimerDriftMaxUs,
+                  ( unsigned long ) stats.TimerLost, ( unsigned long ) stats.TimerTruncated );
+    mcu.MMprint ( "irq %lu run, %lu late over %lu us, latest %lu us\n", ( unsigned long ) stats.IrqNumber, ( unsigned long ) stats.IrqLate,
+                  ( unsigned long ) POSIX_DEADLINE_US, ( unsigned long ) stats.IrqLateMaxUs );
+    mcu.MMprint ( "flash %lu bytes programmed, %lu erased\n", ( unsigned long ) stats.FlashProgrammed, ( unsigned long ) stats.FlashErased );
+    mcu.MMprint ( "watchdog %lu released, %lu refused, margin min %lu ms\n", ( unsigned long ) stats.WatchDogReleases,
+                  ( unsigned long ) stats.WatchDogRefused, ( unsigned long ) stats.WatchDogMarginMinMs );
+    for ( int i = 0; i < WatchDogTaskNumber; i++ ) {
+        mcu.MMprint ( "  task %-8s timeout %lu ms, margin min %ld ms\n", WatchDogTasks [ i ].Name,
+                      ( unsigned long ) WatchDogTasks [ i ].TimeoutMs, ( long ) WatchDogTasks [ i ].MarginMinMs );
+    }
+}
+
+/******************************************************************************/
+/*                                 Flash image                                */
+/******************************************************************************/
+static int PosixFlashOffset ( uint32_t addr, uint32_t size ) {
+    if ( ( addr < POSIX_FLASH_BASE ) || ( ( uint64_t ) addr + size > ( uint64_t ) POSIX_FLASH_BASE + POSIX_FLASH_SIZE ) ) {
+        MMLOG_ERROR ( FLASH, "flash access out of range 0x%08lx %lu \n", ( unsigned long ) addr, ( unsigned long ) size );
+        return ( -1 );
+    }
+    return ( ( int ) ( addr - POSIX_FLASH_BASE ) );
+}
+
+static void PosixFlashSave ( uint32_t offset, uint32_t size ) {
+    if ( FlashFile != NULL ) {
+        fseek ( FlashFile, offset, SEEK_SET );
+        fwrite ( &FlashImage [ offset ], 1, size, FlashFile );
+        fflush ( FlashFile );
+    }
+}
+
+static void PosixFlashOpen ( void ) {
+    const char * name = getenv ( "MCU_POSIX_FLASH" );
+    if ( name == NULL ) {
+        name = "mcu_flash.bin";
+    }
+    memset ( FlashImage, 0xFF, sizeof ( FlashImage ) );
+    if ( name [ 0 ] == '\0' ) {
+        return; // image in memory only
+    }
+    FlashFile = fopen ( name, "r+b" );
+    if ( ( FlashFile != NULL ) && ( fread ( FlashImage, 1, sizeof ( FlashImage ), FlashFile ) == sizeof ( FlashImage ) ) ) {
+        return;
+    }
+    // missing or truncated : start from an erased flash
+    if ( FlashFile != NULL ) {
+        fclose ( FlashFile );
+    }
+    memset ( FlashImage, 0xFF, sizeof ( FlashImage ) );
+    FlashFile = fopen ( name, "w+b" );
+    if ( FlashFile == NULL ) {
+        MMLOG_WARN ( FLASH, "can't open %s, the flash is not persistent \n", name );
+        return;
+    }
+    PosixFlashSave ( 0, sizeof ( FlashImage ) );
+}
+
+static void PosixFlashErasePage ( uint32_t offset ) {
+    offset &= ~( uint32_t ) ( POSIX_FLASH_PAGE_SIZE - 1 );
+    memset ( &FlashImage [ offset ], 0xFF, POSIX_FLASH_PAGE_SIZE );
+    Stats.FlashErased += POSIX_FLASH_PAGE_SIZE;
+    PosixFlashSave ( offset, POSIX_FLASH_PAGE_SIZE );
+}
+
+/* HAL_FLASH_Program rules : aligned double word, erased before (PROGERR otherwise) */
+static int PosixFlashProgram ( uint32_t offset, const uint8_t * data ) {
+    if ( ( offset & 7 ) != 0 ) {
+        MMLOG_ERROR ( FLASH, "unaligned double word at 0x%08lx \n", ( unsigned long ) ( POSIX_FLASH_BASE + offset ) );
+        return ( -1 );
+    }
+    for ( int i = 0; i < 8; i++ ) {
+        if ( FlashImage [ offset + i ] != 0xFF ) {
+            MMLOG_ERROR ( FLASH, "double word at 0x%08lx is not erased \n", ( unsigned long ) ( POSIX_FLASH_BASE + offset ) );
+            return ( -1 );
+        }
+    }
+    memcpy ( &FlashImage [ offset ], data, 8 );
+    Stats.FlashProgrammed += 8;
+    PosixFlashSave ( offset, 8 );
+    return ( 0 );
+}
+
+/*************************************************************/
+/*           Mcu Object Definition Constructor               */
+/*************************************************************/
+McuPosix::McuPosix ( PinName mosi, PinName miso, PinName sclk ) {
+    Func = DoNothing;
+    obj = NULL;
+    Funcext = NULL;
+    objext = NULL;
+    _UserFuncext = NULL;
+    userIt = 0;
+    IrqPin = NC;
+    UartBaud = UART_TRACE_BAUD;
+    GpioHook = NULL;
+    SpiHook = NULL;
+    McuMosi = mosi;
+    McuMiso = miso;
+    McuSclk = sclk;
+}
+McuPosix::~McuPosix ( ) {
+}
+
+/*******************************************/
+/*                  Mcu Init               */
+/*******************************************/
+void McuPosix::InitMcu ( void ) {
+    const char * scale = getenv ( "MCU_POSIX_TIME_SCALE" );
+    {
+        std::lock_guard < std::mutex > lock ( ClockMutex );
+        RealBase = PosixClock::now ( );
+        VirtualBaseUs = 0;
+    }
+    SetTimeScale ( ( scale != NULL ) ? atof ( scale ) : 0 );
+    McuPosixResetStats ( );
+    PosixFlashOpen ( );
+    if ( Discrete != 0 ) {
+        MMLOG_INFO ( MCU, "posix mcu, discrete event clock \n" );
+    } else {
+        MMLOG_INFO ( MCU, "posix mcu, virtual clock x%g \n", TimeScale );
+    }
+}
+
+void McuPosix::Init_Irq ( PinName pin ) {
+    IrqPin = pin;
+}
+
+void McuPosix::SetTimeScale ( double scale ) {
+    std::lock_guard < std::mutex > lock ( ClockMutex );
+    VirtualBaseUs = PosixNowUsLocked ( );
+    RealBase = PosixClock::now ( );
+    Discrete = ( scale > 0 ) ? 0 : 1;
+    TimeScale = scale;
+    if ( ( Discrete == 0 ) && ( IrqThreadStarted == 0 ) ) {
+        IrqThreadStarted = 1;
+        std::thread ( PosixIrqThread ).detach ( );
+    }
+    ClockChanged.notify_all ( );
+}
+
+int McuPosix::PostEvent ( uint32_t delayUs, void (* func) ( void * ), void * ctx ) {
+    std::lock_guard < std::mutex > lock ( ClockMutex );
+    for ( int i = 0; i < POSIX_MAX_EVENTS; i++ ) {
+        if ( Events [ i ].Func == NULL ) {
+            Events [ i ].DueUs = PosixNowUsLocked ( ) + delayUs;
+            Events [ i ].Func  = func;
+            Events [ i ].Ctx   = ctx;
+            ClockChanged.notify_all ( );
+            return ( 0 );
+        }
+    }
+    return ( -1 );
+}
+
+/******************************************************************************/
+/*                                Mcu Spi Api                                 */
+/******************************************************************************/
+uint8_t McuPosix::SpiWrite ( int value ) {
+    PosixCallCost ( );
+    return ( ( SpiHook != NULL ) ? SpiHook ( ( uint8_t ) ( value & 0xFF ) ) : 0 );
+}
+
+/******************************************************************************/
+/*                                Mcu Flash Api                               */
+/******************************************************************************/
+int McuPosix::RestoreContext ( uint8_t * buffer, uint32_t addr, uint32_t size ) {
+    int offset = PosixFlashOffset ( addr, size );
+    if ( offset < 0 ) {
+        return ( -1 );
+    }
+    memcpy ( buffer, &FlashImage [ offset ], size );
+    return ( 0 );
+}
+
+int McuPosix::StoreContext ( const void * buffer, uint32_t addr, uint32_t size ) {
+    MMPROFILE ( "StoreContext" );
+    const uint8_t * data = ( const uint8_t * ) buffer;
+    int offset = PosixFlashOffset ( addr, 8 * size );
+    if ( ( offset < 0 ) || ( size == 0 ) ) {
+        return ( -1 );
+    }
+    uint32_t page = offset & ~( uint32_t ) ( POSIX_FLASH_PAGE_SIZE - 1 );
+    for ( ; page < offset + 8 * size; page += POSIX_FLASH_PAGE_SIZE ) {
+        PosixFlashErasePage ( page );
+    }
+    for ( uint32_t i = 0; i < size; i++ ) {
+        if ( PosixFlashProgram ( offset + 8 * i, &data [ 8 * i ] ) != 0 ) {
+            return ( -1 );
+        }
+    }
+    return ( 0 );
+}
+
+int McuPosix::WriteFlashWithoutErase ( uint8_t * buffer, uint32_t addr, uint32_t size ) {
+    uint8_t copyPage [ POSIX_FLASH_PAGE_SIZE ];
+    int offset = PosixFlashOffset ( addr, size );
+    if ( offset < 0 ) {
+        return ( -1 );
+    }
+    uint32_t end = offset + size;
+    uint32_t page = offset & ~( uint32_t ) ( POSIX_FLASH_PAGE_SIZE - 1 );
+    for ( ; page < end; page += POSIX_FLASH_PAGE_SIZE ) {
+        memcpy ( copyPage, &FlashImage [ page ], POSIX_FLASH_PAGE_SIZE );
+        for ( uint32_t i = 0; i < POSIX_FLASH_PAGE_SIZE; i++ ) {
+            if ( ( page + i >= ( uint32_t ) offset ) && ( page + i < end ) ) {
+                copyPage [ i ] = buffer [ page + i - offset ];
+            }
+        }
+        PosixFlashErasePage ( page );
+        for ( uint32_t i = 0; i < POSIX_FLASH_PAGE_SIZE; i += 8 ) {
+            if ( PosixFlashProgram ( page + i, &copyPage [ i ] ) != 0 ) {
+                return ( -1 );
+            }
+        }
+    }
+    return ( 0 );
+}
+
+/******************************************************************************/
+/*                                Mcu RTC Api                                 */
+/******************************************************************************/
+uint32_t McuPosix::RtcGetTimeSecond ( void ) {
+    PosixCallCost ( );
+    return ( ( uint32_t ) ( McuPosixNowUs ( ) / 1000000 ) );
+}
+
+uint32_t McuPosix::RtcGetTimeMs ( void ) {
+    PosixCallCost ( );
+    return ( ( uint32_t ) ( McuPosixNowUs ( ) / 1000 ) );
+}
+
+/******************************************************************************/
+/*                                Mcu Sleep Api                               */
+/******************************************************************************/
+void McuPosix::GotoSleepSecond ( int duration ) {
+    int cpt = duration ;
+    WatchDogSleeping = 1;
+    WatchDogRelease ( );
+    while ( cpt > ( WATCH_DOG_PERIOD_RELEASE ) ) {
+        cpt -= WATCH_DOG_PERIOD_RELEASE ;
+        PosixSleepUs ( ( uint64_t ) WATCH_DOG_PERIOD_RELEASE * 1000000, LOW_POWER_MODE );
+        WatchDogRelease ( );
+    }
+    PosixSleepUs ( ( uint64_t ) cpt * 1000000, LOW_POWER_MODE );
+    WatchDogRelease ( );
+    WatchDogSleeping = 0;
+}
+
+void McuPosix::GotoSleepMSecond ( int duration ) {
+    PosixSleepUs ( ( uint64_t ) duration * 1000, LOW_POWER_MODE );
+    WatchDogRelease ( );
+}
+
+void McuPosix::mwait ( int delays ) {
+    PosixSleepUs ( ( uint64_t ) delays * 1000000, 0 );
+}
+
+void McuPosix::mwait_ms ( int delayms ) {
+    PosixSleepUs ( ( uint64_t ) delayms * 1000, 0 );
+}
+
+/******************************************************************************/
+/*                             Mcu WatchDog Api                               */
+/******************************************************************************/
+void McuPosix::WatchDogStart ( void ) {
+    std::lock_guard < std::mutex > lock ( ClockMutex );
+    IwdgDueUs = PosixNowUsLocked ( ) + ( uint64_t ) POSIX_IWDG_PERIOD_MS * 1000;
+    IwdgStarted = 1;
+    ClockChanged.notify_all ( );
+}
+
+void McuPosix::WatchDogRelease ( void ) {
+    PosixCallCost ( );
+    std::lock_guard < std::mutex > lock ( ClockMutex );
+    uint32_t now = ( uint32_t ) ( PosixNowUsLocked ( ) / 1000 );
+    for ( int i = 0; i < WatchDogTaskNumber; i++ ) {
+        if ( ( WatchDogSleeping != 0 ) && ( WatchDogTasks [ i ].Thread != 0 ) ) {
+            WatchDogTasks [ i ].LastCheckInMs = now; // the task can not run before GotoSleepSecond returns
+        }
+        int32_t margin = ( int32_t ) WatchDogTasks [ i ].TimeoutMs - ( int32_t ) ( now - WatchDogTasks [ i ].LastCheckInMs );
+        if ( margin < WatchDogTasks [ i ].MarginMinMs ) {
+            WatchDogTasks [ i ].MarginMinMs = margin;
+        }
+        if ( margin < 0 ) {
+            WatchDogLate = WatchDogTasks [ i ].Name;
+            Stats.WatchDogRefused++;
+            return;
+        }
+    }
+    if ( IwdgStarted == 0 ) {
+        return;
+    }
+    uint32_t margin = ( uint32_t ) ( ( IwdgDueUs - PosixNowUsLocked ( ) ) / 1000 );
+    if ( margin < Stats.WatchDogMarginMinMs ) {
+        Stats.WatchDogMarginMinMs = margin;
+    }
+    Stats.WatchDogReleases++;
+    WatchDogLate = NULL;
+    IwdgDueUs = PosixNowUsLocked ( ) + ( uint64_t ) POSIX_IWDG_PERIOD_MS * 1000;
+    ClockChanged.notify_all ( );
+}
+
+int McuPosix::WatchDogRegister ( const char * name, uint32_t timeoutSecond ) {
+    std::lock_guard < std::mutex > lock ( ClockMutex );
+    if ( WatchDogTaskNumber >= WATCH_DOG_MAX_TASKS ) {
+        return ( -1 );
+    }
+    WatchDogTasks [ WatchDogTaskNumber ].Name = name;
+    WatchDogTasks [ WatchDogTaskNumber ].TimeoutMs = timeoutSecond * 1000;
+    WatchDogTasks [ WatchDogTaskNumber ].LastCheckInMs = ( uint32_t ) ( PosixNowUsLocked ( ) / 1000 );
+    WatchDogTasks [ WatchDogTaskNumber ].MarginMinMs = ( int32_t ) ( timeoutSecond * 1000 );
+    WatchDogTasks [ WatchDogTaskNumber ].Thread = 1;
+    return ( WatchDogTaskNumber++ );
+}
+
+void McuPosix::WatchDogCheckIn ( int id ) {
+    std::lock_guard < std::mutex > lock ( ClockMutex );
+    if ( ( id >= 0 ) && ( id < WatchDogTaskNumber ) ) {
+        WatchDogTasks [ id ].LastCheckInMs = ( uint32_t ) ( PosixNowUsLocked ( ) / 1000 );
+        WatchDogTasks [ id ].Thread = ( InIrq == 0 ) ? 1 : 0;
+    }
+}
+
+/******************************************************************************/
+/*                             Mcu LOwPower timer Api                         */
+/******************************************************************************/
+void McuPosix::LowPowerTimerLoRaInit ( ) {
+    Func = DoNothing;
+    obj = NULL;
+}
+
+void McuPosix::StartTimerMsecond ( void (* _Func) (void *) , void * _obj, int delay ) {
+    PosixCallCost ( );
+    // same conversion as McuSTM32L4, the compare register is 16 bits
+    uint32_t ticks = delay * 2 + ( ( 6 * delay ) >> 7 );
+    std::lock_guard < std::mutex > lock ( ClockMutex );
+    if ( ticks > 0xFFFF ) {
+        Stats.TimerTruncated++;
+        ticks &= 0xFFFF;
+    }
+    if ( TimerArmed != 0 ) {
+        Stats.TimerLost++;
+    }
+    Func = _Func;
+    obj  = _obj;
+    TimerRequestedUs = PosixNowUsLocked ( ) + ( uint64_t ) delay * 1000;
+    TimerDueUs = PosixNowUsLocked ( ) + ( ( uint64_t ) ticks * 1000000 + POSIX_LPTIM_HZ / 2 ) / POSIX_LPTIM_HZ;
+    TimerArmed = 1;
+    ClockChanged.notify_all ( );
+}
+
+/******************************************************************************/
+/*                           Mcu Gpio Api                                     */
+/******************************************************************************/
+void McuPosix::SetValueDigitalOutPin ( PinName Pin, int Value ) {
+    if ( Pin == NC ) {
+        return;
+    }
+    PinLevel [ Pin & 0xFF ] = ( Value != 0 );
+    if ( GpioHook != NULL ) {
+        GpioHook ( Pin, Value );
+    }
+}
+
+int McuPosix::GetValueDigitalInPin ( PinName Pin ) {
+    return ( ( Pin == NC ) ? 0 : PinLevel [ Pin & 0xFF ] );
+}
+
+void McuPosix::AttachInterruptIn ( void (* _Funcext) (void *) , void * _objext ) {
+    Funcext = _Funcext;
+    objext  = _objext;
+    userIt  = 0;
+}
+
+void McuPosix::SetInputPin ( PinName pin, int value ) {
+    if ( pin == NC ) {
+        return;
+    }
+    McuPosixIrqLock ( );
+    int rising = ( PinLevel [ pin & 0xFF ] == 0 ) && ( value != 0 );
+    PinLevel [ pin & 0xFF ] = ( value != 0 );
+    int run = rising && ( pin == IrqPin ) && ( ( userIt != 0 ) || ( Funcext != NULL ) );
+    if ( rising && ( pin == IrqPin ) ) {
+        McuTaskSignal ( TASK_SIGNAL_PIN ( pin & 0x0F ) ); // HAL_GPIO_EXTI_Callback on the target
+    }
+    if ( run ) {
+        InIrq = 1;
+        ExtISR ( );
+        InIrq = 0;
+        Stats.IrqNumber++;
+    }
+    McuPosixIrqUnlock ( );
+    if ( run ) {
+        std::lock_guard < std::mutex > lock ( ClockMutex );
+        IrqCount++;
+        ClockChanged.notify_all ( );
+    }
+}
+
+/******************************************************************************/
+/*                           Mcu Uart Api                                     */
+/******************************************************************************/
+void McuPosix::MMprint ( const char * fmt, ... ) {
+#if DEBUG_TRACE == 1
+    char * string = ( char * ) McuPoolAlloc ( POSIX_PRINT_BUFFER_SIZE );
+    if ( string == NULL ) { // counted in the pool failures
+        return;
+    }
+    va_list argp;
+    va_start ( argp, fmt );
+    int length = vsnprintf ( string, POSIX_PRINT_BUFFER_SIZE, fmt, argp );
+    va_end ( argp );
+    if ( length > 0 ) {
+        length = ( length < POSIX_PRINT_BUFFER_SIZE ) ? length : POSIX_PRINT_BUFFER_SIZE - 1;
+#if BINARY_TRACE == 1
+        McuTracePushText ( string, length );
+#else
+        McuPosixUartWrite ( ( const uint8_t * ) string, length );
+#endif
+    }
+    McuPoolFree ( string );
+#endif
+}
+
+void McuPosix::TraceFlush ( void ) {
+#if ( DEBUG_TRACE == 1 ) && ( BINARY_TRACE == 1 )
+    McuTraceFlush ( );
+#endif
+}
+
+void McuPosix::SetUartHook ( void (* hook) ( const uint8_t * data, uint32_t length ) ) {
+    UartHook = hook;
+}
+
+/*****************************************************************************/
+/*                                    Get Unique Id                          */
+/*****************************************************************************/
+void McuPosix::GetUniqueId ( uint8_t DevEui[8] ) {
+    const char * uidText = getenv ( "MCU_POSIX_UID" );
+    uint64_t uid = ( uidText != NULL ) ? strtoull ( uidText, NULL, 16 ) : 0x0011223344556677ULL;
+    for ( int i = 7; i >= 0; i-- ) {
+        DevEui [ i ] = ( uint8_t ) ( uid & 0xFF );
+        uid >>= 8;
+    }
+}
@@ -0,0 +1,398 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Host simulation MCU (build with -DMCU_POSIX, make posix).
+                    Same prototype as McuSTM32L4 so the Mcu layer and the stack above it run on a
+                    Linux host :
+                    - flash : 1 MB image mapped at 0x08000000 and backed by a file, 2 KB pages erased
+                      to 0xFF, double words programmed only once between two erases like on the L4
+                    - virtual clock : discrete event by default, the time only moves when the code
+                      sleeps, waits or calls the Mcu api (POSIX_CALL_COST_US per call) and it jumps to
+                      the next interrupt : a week of operation runs in seconds and every run is the same.
+                      With MCU_POSIX_TIME_SCALE > 0 it runs that many times faster than the host clock
+                    - interrupts : the LPTIM timer, the external pin interrupt and the events posted
+                      by the simulation run in the sleeps and the api calls in discrete event mode, on
+                      an interrupt thread otherwise, McuEnterCritical holds it off
+                    - report : timer drift of the LPTIM tick conversion, late or lost interrupts and
+                      watchdog margin (McuPosixPrint)
+                    - gpio and spi : hooks let a simulated radio see the pins and the spi bytes
+                    The IWDG is emulated : an expiry prints the late task and ends the process.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef McuPosix_H
+#define McuPosix_H
+#include "stdint.h"
+#include "stdio.h"
+#include "string.h"
+#include "McuEvent.h"
+
+#define POSIX_FLASH_BASE      0x08000000U
+#define POSIX_FLASH_SIZE      ( 1024 * 1024 )
+#define POSIX_FLASH_PAGE_SIZE 2048
+#define POSIX_IWDG_PERIOD_MS  32000     // same expiry as MX_IWDG_Init
+#define POSIX_MAX_EVENTS      8         // events posted with PostEvent and not yet run
+#define POSIX_PRINT_BUFFER_SIZE 256    // one MMprint line, from the 256 bytes pool like the target
+#ifndef POSIX_CALL_COST_US
+    #define POSIX_CALL_COST_US 1        // discrete event mode : time taken by an Mcu api call
+#endif
+#ifndef POSIX_LPTIM_HZ
+    #define POSIX_LPTIM_HZ     2048     // LPTIM tick rate assumed by the StartTimerMsecond conversion
+#endif
+#ifndef POSIX_IDLE_MAX_US
+    #define POSIX_IDLE_MAX_US  1000     // McuEventIdle wakes up at least that often, like the SysTick on the target
+#endif
+#ifndef POSIX_DEADLINE_US
+    #define POSIX_DEADLINE_US  1000     // an interrupt run later than that after its due time is reported
+#endif
+
+/* PinName of the STM32L4 board : UserDefine.h names the radio pins with it */
+typedef enum {
+    PA_0  = 0x00,
+    PA_1  = 0x01,
+    PA_2  = 0x02,
+    PA_3  = 0x03,
+    PA_4  = 0x04,
+    PA_5  = 0x05,
+    PA_6  = 0x06,
+    PA_7  = 0x07,
+    PA_8  = 0x08,
+    PA_9  = 0x09,
+    PA_10 = 0x0A,
+    PA_11 = 0x0B,
+    PA_12 = 0x0C,
+    PA_13 = 0x0D,
+    PA_14 = 0x0E,
+    PA_15 = 0x0F,
+
+    PB_0  = 0x10,
+    PB_1  = 0x11,
+    PB_2  = 0x12,
+    PB_3  = 0x13,
+    PB_4  = 0x14,
+    PB_5  = 0x15,
+    PB_6  = 0x16,
+    PB_7  = 0x17,
+    PB_8  = 0x18,
+    PB_9  = 0x19,
+    PB_10 = 0x1A,
+    PB_11 = 0x1B,
+    PB_12 = 0x1C,
+    PB_13 = 0x1D,
+    PB_14 = 0x1E,
+    PB_15 = 0x1F,
+
+    PC_0  = 0x20,
+    PC_1  = 0x21,
+    PC_2  = 0x22,
+    PC_3  = 0x23,
+    PC_4  = 0x24,
+    PC_5  = 0x25,
+    PC_6  = 0x26,
+    PC_7  = 0x27,
+    PC_8  = 0x28,
+    PC_9  = 0x29,
+    PC_10 = 0x2A,
+    PC_11 = 0x2B,
+    PC_12 = 0x2C,
+    PC_13 = 0x2D,
+    PC_14 = 0x2E,
+    PC_15 = 0x2F,
+
+    PD_2  = 0x32,
+
+    PH_0  = 0x70,
+    PH_1  = 0x71,
+
+    // ADC internal channels
+    ADC_TEMP = 0xF0,
+    ADC_VREF = 0xF1,
+    ADC_VBAT = 0xF2,
+
+    // Arduino connector namings
+    A0          = PA_0,
+    A1          = PA_1,
+    A2          = PA_4,
+    A3          = PB_0,
+    A4          = PC_1,
+    A5          = PC_0,
+    D0          = PA_3,
+    D1          = PA_2,
+    D2          = PA_10,
+    D3          = PB_3,
+    D4          = PB_5,
+    D5          = PB_4,
+    D6          = PB_10,
+    D7          = PA_8,
+    D8          = PA_9,
+    D9          = PC_7,
+    D10         = PB_6,
+    D11         = PA_7,
+    D12         = PA_6,
+    D13         = PA_5,
+    D14         = PB_9,
+    D15         = PB_8,
+
+    // Generic signals namings
+    LED1        = PA_5,
+    LED2        = PA_5,
+    LED3        = PA_5,
+    LED4        = PA_5,
+    USER_BUTTON = PC_13,
+    // Standardized button names
+    BUTTON1 = USER_BUTTON,
+    SERIAL_TX   = PA_2,
+    SERIAL_RX   = PA_3,
+
+    I2C_SCL     = PB_8,
+    I2C_SDA     = PB_9,
+    SPI_MOSI    = PA_7,
+    SPI_MISO    = PA_6,
+    SPI_SCK     = PA_5,
+    SPI_CS      = PB_6,
+    PWM_OUT     = PB_3,
+
+    //USB pins
+
+    // Not connected
+    NC = (int)0xFFFFFFFF
+} PinName;
+
+/*!
+ * McuPosixIrqLock / McuPosixIrqUnlock : the simulated PRIMASK, held by the interrupt thread while
+ * a handler runs and by McuEnterCritical, recursive like a nested critical section
+ */
+void     McuPosixIrqLock   ( void );
+void     McuPosixIrqUnlock ( void );
+
+/*!
+ * McuPosixNowUs : virtual time since InitMcu in us
+ */
+uint64_t McuPosixNowUs     ( void );
+
+/*!
+ * McuPosixPrint : timer drift, late and lost interrupts, watchdog margin since McuPosixResetStats
+ */
+void     McuPosixPrint      ( void );
+void     McuPosixResetStats ( void );
+
+/*!
+ * McuPosixFlashCounters : bytes programmed and erased since McuPosixResetStats, the flash wear
+ */
+void     McuPosixFlashCounters ( uint64_t * programmed, uint64_t * erased );
+
+/*!
+ * McuPosixIdle : wait for the next simulated interrupt, maxUs at most (McuEventIdle)
+ */
+void     McuPosixIdle      ( uint64_t maxUs );
+
+/*!
+ * McuPosixUartWrite : the simulated debug uart, written to the standard output
+ */
+void     McuPosixUartWrite ( const uint8_t * data, uint32_t length );
+
+class McuPosix {
+public :
+     McuPosix ( PinName mosi, PinName miso, PinName sclk );
+    ~McuPosix ( );
+    /*!
+    * InitMcu : open the flash image, start the virtual clock and the interrupt thread
+    * \remark the environment may set MCU_POSIX_FLASH (image file, mcu_flash.bin by default, empty for no file)
+    *         and MCU_POSIX_TIME_SCALE (virtual seconds per host second, 0 for discrete event)
+    */
+    void InitMcu ( void );
+    void Init_Irq ( PinName pin );
+/******************************************************************************/
+/*                                Mcu Spi Api                                 */
+/******************************************************************************/
+    void InitSpi ( ) { };
+    /*!
+    * SpiWrite : the byte is given to the spi hook, its answer is the byte read
+    * \remark 0 is read when no hook is set
+    */
+    uint8_t SpiWrite ( int value );
+    void Spiformat ( int bits, int mode = 0 ) { } ;
+    void SetSpiFrequency ( int hz = 1000000 ) { } ;
+    PinName McuMosi;
+    PinName McuMiso;
+    PinName McuSclk;
+
+/******************************************************************************/
+/*                                Mcu Flash Api                               */
+/******************************************************************************/
+    /*!
+    * RestoreContext : read size bytes of the flash image
+    * \param [OUT]  int 0 on success, -1 outside of the flash
+    */
+    int RestoreContext ( uint8_t * buffer, uint32_t addr, uint32_t size );
+    /*!
+    * StoreContext : erase the pages from addr and program size double words
+    * \remark addr have to be 8 bytes aligned, like HAL_FLASH_Program
+    * \param [OUT]  int 0 on success, -1 on a programming error
+    */
+    int StoreContext ( const void * buffer, uint32_t addr, uint32_t size );
+    /*!
+    * WriteFlashWithoutErase : read-modify-erase-program of the pages holding size bytes at addr
+    * \param [OUT]  int 0 on success, -1 on a programming error
+    */
+    int WriteFlashWithoutErase ( uint8_t * buffer, uint32_t addr, uint32_t size );
+
+/******************************************************************************/
+/*                                Mcu RTC Api                                 */
+/******************************************************************************/
+    void     RtcInit            ( void ) { };
+    uint32_t RtcGetTimeSecond   ( void ) ;
+    uint32_t RtcGetTimeMs       ( void ) ;
+
+/******************************************************************************/
+/*                                Mcu Sleep Api                               */
+/******************************************************************************/
+    /*!
+    * GotoSleepSecond / GotoSleepMSecond : wait on the virtual clock
+    * \remark with LOW_POWER_MODE set, any simulated interrupt ends the sleep early like the stop mode
+    */
+    void GotoSleepSecond  ( int duration ) ;
+    void GotoSleepMSecond ( int delay );
+
+/******************************************************************************/
+/*                             Mcu WatchDog Api                               */
+/******************************************************************************/
+    void WatchDogStart    ( void ) ;
+    void WatchDogRelease  ( void ) ;
+    int  WatchDogRegister ( const char * name, uint32_t timeoutSecond ) ;
+    void WatchDogCheckIn  ( int id ) ;
+
+/******************************************************************************/
+/*                             Mcu LowPower timer Api                         */
+/******************************************************************************/
+    void LowPowerTimerLoRaInit ( void );
+    /*!
+    * StartTimerMsecond : one shot timer on the virtual clock, Func ( obj ) runs as an interrupt
+    * \remark the delay is converted in LPTIM ticks like on the target, then run at POSIX_LPTIM_HZ
+    * \param [IN] int delay in ms delay should be between 1ms and 16s.
+    */
+    void StartTimerMsecond     ( void (* _Func) (void *) , void * _obj, int delay) ;
+    void timerISR              ( void ) {
+#if EVENT_LOOP_ENABLE == 1
+        McuEventPost ( EVENT_QUEUE_TIMER, Func, obj );
+#else
+        Func(obj);
+#endif
+    };
+    void * TimerCallback       ( void ) { return ( ( void * ) Func ); };
+
+/******************************************************************************/
+/*                           Mcu Gpio Api                                     */
+/******************************************************************************/
+    void SetValueDigitalOutPin ( PinName Pin, int Value );
+    int  GetValueDigitalInPin  ( PinName Pin );
+    void AttachInterruptIn     (  void (* _Funcext) (void *) , void * _objext) ;
+    void AttachInterruptIn     (  void (* _Funcext) ( void ) ) { _UserFuncext = _Funcext; userIt = 1 ; };
+    void DetachInterruptIn     (  void (* _Funcext) ( void ) ) { userIt = 0 ; };
+    void ExtISR                ( void ) {
+#if EVENT_LOOP_ENABLE == 1
+        if (userIt == 0 ) {
+        McuEventPost ( EVENT_QUEUE_RADIO, Funcext, objext );
+        } else {
+        McuEventPostVoid ( EVENT_QUEUE_RADIO, _UserFuncext );
+        };
+#else
+        if (userIt == 0 ) {
+        Funcext(objext);
+        } else {
+        _UserFuncext ();
+        };
+#endif
+    };
+
+/******************************************************************************/
+/*                           Mcu Memory Api                                   */
+/******************************************************************************/
+    uint32_t StackHighWaterMark ( void ) { return ( 0 ); };
+    uint32_t HeapPeak           ( void ) { return ( 0 ); };
+
+/******************************************************************************/
+/*                           Mcu Energy Api                                   */
+/******************************************************************************/
+    void     EnergyConsumer     ( uint8_t state, int on ) { };
+    void     EnergyUpdate       ( void ) { };
+    uint64_t EnergyChargeNah    ( void ) { return ( 0 ); };
+
+/******************************************************************************/
+/*                           Mcu wait                                         */
+/******************************************************************************/
+    void mwait    ( int delays );
+    void mwait_ms ( int delayms );
+
+/******************************************************************************/
+/*                           Mcu Uart Api                                     */
+/******************************************************************************/
+    void UartInit ( void ) { };
+    void MMprint ( const char * fmt, ... );
+    void ConsoleProcess ( void ) { };
+    int SetUartBaud ( uint32_t baud ) { UartBaud = baud; return ( 0 ); };
+    uint32_t GetUartBaud ( void ) { return ( UartBaud ); };
+    void TraceFlush ( void );
+
+/*****************************************************************************/
+/*                                    Get Unique Id                          */
+/*****************************************************************************/
+    /*!
+    * GetUniqueId : 8 bytes of MCU_POSIX_UID (hexadecimal) or 0x0011223344556677
+    */
+    void GetUniqueId ( uint8_t  DevEui[8] );
+
+/*****************************************************************************/
+/*                           Simulation Api (host only)                      */
+/*****************************************************************************/
+    /*!
+    * SetGpioHook : hook called on every SetValueDigitalOutPin, e.g. the radio chip select or reset
+    */
+    void SetGpioHook  ( void (* hook) ( PinName pin, int value ) ) { GpioHook = hook; };
+    /*!
+    * SetSpiHook : hook answering the spi bytes, the chip select tells the frames apart
+    */
+    void SetSpiHook   ( uint8_t (* hook) ( uint8_t value ) ) { SpiHook = hook; };
+    /*!
+    * SetUartHook : hook receiving the debug uart output instead of the standard output
+    */
+    void SetUartHook  ( void (* hook) ( const uint8_t * data, uint32_t length ) );
+    /*!
+    * SetInputPin : drive an input pin, a rising edge on the Init_Irq pin runs ExtISR
+    * \remark from the simulation : a hook, an event or another thread
+    */
+    void SetInputPin  ( PinName pin, int value );
+    /*!
+    * PostEvent : run func ( ctx ) as an interrupt delayUs virtual us from now
+    * \remark e.g. the TxDone of a simulated radio after the time on air
+    * \param [OUT] int 0, -1 if POSIX_MAX_EVENTS events are pending
+    */
+    int  PostEvent    ( uint32_t delayUs, void (* func) ( void * ), void * ctx );
+    /*!
+    * SetTimeScale : virtual seconds per host second, 0 for the discrete event clock
+    */
+    void SetTimeScale ( double scale );
+private :
+    static void DoNothing (void *) { };
+    void (* Func) (void *);
+    void * obj;
+    void (* Funcext) (void *);
+    void * objext;
+    void (* _UserFuncext) ( void );
+    int userIt;
+    PinName IrqPin;
+    uint32_t UartBaud;
+    void    (* GpioHook) ( PinName pin, int value );
+    uint8_t (* SpiHook) ( uint8_t value );
+};
+
+#endif
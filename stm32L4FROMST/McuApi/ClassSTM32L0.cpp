@@ -7,25 +7,20 @@
  |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___| 
                                                    
                                                    
-Description       : Flash Api.  
+Description       : STM32L0 MCU, the part not shared with the other families (McuCore.h).
 
 
 License           : Revised BSD License, see LICENSE.TXT file include in the project
 
 Maintainer        : Fabien Holin (SEMTECH)
 */
-#if 0
 #include "ClassSTM32L0.h"
 #include "stdint.h"
 #include "ApiMcu.h"
 #include "stm32l0xx_hal.h"
-#define WATCH_DOG_PERIOD_RELEASE 30 // this period have to be lower than the Watch Dog period of 32 seconds
-#if DEBUG_TRACE == 1
-    #include <stdarg.h>
-    #include <string.h>
-#endif
-#include "main.h"
-UART_HandleTypeDef UartHandle;
+#include "McuLog.h"
+#include "McuTrace.h"
+UART_HandleTypeDef UartHandle; // also used by McuTrace
 
 
 /**
@@ -68,7 +63,7 @@ void SystemClock_Config(void)
     RCC_OscInitStruct.PLL.PLLMUL          = RCC_PLLMUL_4;
     RCC_OscInitStruct.PLL.PLLDIV          = RCC_PLLDIV_2;
     if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK) {
-        DEBUG_MSG("ERROR\n");
+        MMLOG_ERROR(MCU, "clock configuration failed\n");
     }
 
     /* Select PLL as system clock source and configure the HCLK, PCLK1 and PCLK2 clocks dividers */
@@ -78,7 +73,7 @@ void SystemClock_Config(void)
     RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV1;           // 32 MHz
     RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;           // 32 MHz
     if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_1) != HAL_OK) {
-        DEBUG_MSG("ERROR\n");
+        MMLOG_ERROR(MCU, "clock configuration failed\n");
     }
     RCC_PeriphCLKInitTypeDef PeriphClkInit;
     PeriphClkInit.PeriphClockSelection = RCC_PERIPHCLK_USART1|RCC_PERIPHCLK_RTC|RCC_PERIPHCLK_LPTIM1;
@@ -88,7 +83,7 @@ void SystemClock_Config(void)
 
     if (HAL_RCCEx_PeriphCLKConfig(&PeriphClkInit) != HAL_OK)
     {
-        Error_Handler();
+        MMLOG_ERROR(MCU, "peripheral clock configuration failed\n");
     }
     HAL_SYSTICK_Config(HAL_RCC_GetHCLKFreq()/1000);
     /**Configure the Systick */
@@ -117,17 +112,6 @@ void HAL_UART_MspInit(UART_HandleTypeDef *huart)
     HAL_GPIO_Init(USARTx_TX_GPIO_PORT, &GPIO_InitStruct);
 #endif
 }
-#if DEBUG_TRACE == 1
-void vprint(const char *fmt, va_list argp)
-{
-
-    char string[200];
-    if(0 < vsprintf(string,fmt,argp)) // build string
-    {
-        HAL_UART_Transmit(&UartHandle, (uint8_t*)string, strlen(string), 0xffffff); // send message via UART
-    }
-}
-#endif
 /********************************************************************/
 /*                 Low Power Timer local functions                  */
 /********************************************************************/
@@ -144,64 +128,15 @@ void LPTIM1_IRQHandler ( void ) {
     HAL_LPTIM_TimeOut_Stop(&hlptim1);
     mcu.timerISR();
 }
-//void EXTI4_15_IRQHandler(void)
-//{
-//  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_10);
-//}
 void  EXTI4_15_IRQHandler ( void ){
-    int pintmp = TX_RX_IT;
-    if ( pintmp < 15 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << pintmp) );
-    } else if ( pintmp < 31 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 16 )) );
-    } else if ( pintmp < 47 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 32 )) );
-    } else if ( pintmp < 63 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 48 )) );
-    } else if ( pintmp < 79 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 64 )) );
-    } else if ( pintmp < 95 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 80 )) );
-    } else if ( pintmp < 111 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 96 )) );
-    } 
-    pintmp = RX_TIMEOUT_IT;
-    if ( pintmp < 15 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << pintmp) );
-    } else if ( pintmp < 31 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 16 )) );
-    } else if ( pintmp < 47 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 32 )) );
-    } else if ( pintmp < 63 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 48 )) );
-    } else if ( pintmp < 79 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 64 )) );
-    } else if ( pintmp < 95 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 80 )) );
-    } else if ( pintmp < 111 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 96 )) );
-    } 
+    HAL_GPIO_EXTI_IRQHandler ( McuPin < Board::RadioIrq >::Mask );
     mcu.ExtISR();
 }
 
 void  EXTI2_3_IRQHandler ( void ){
-
-    int pintmp = RX_TIMEOUT_IT;
-    if ( pintmp < 15 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << pintmp) );
-    } else if ( pintmp < 31 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 16 )) );
-    } else if ( pintmp < 47 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 32 )) );
-    } else if ( pintmp < 63 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 48 )) );
-    } else if ( pintmp < 79 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 64 )) );
-    } else if ( pintmp < 95 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 80 )) );
-    } else if ( pintmp < 111 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 96 )) );
-    } 
+    if ( McuPin < Board::RxTimeoutIrq >::Mask != 0 ) {
+        HAL_GPIO_EXTI_IRQHandler ( McuPin < Board::RxTimeoutIrq >::Mask );
+    }
     mcu.ExtISR();
 }
 
@@ -230,29 +165,18 @@ void McuSTM32L0::InitMcu ( void ){
 void  McuSTM32L0::Init_Irq ( PinName pin) {
         IRQn_Type IrqNum; 
         int pintmp;
+        if ( pin == NC ) { // RX_TIMEOUT_IT of the sx126x board, on TX_RX_IT
+            return;
+        }
       /* Enable GPIOC clock */
   __HAL_RCC_GPIOC_CLK_ENABLE();
         GPIO_InitTypeDef GPIO_InitStruct;
         GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
         GPIO_InitStruct.Pull = GPIO_NOPULL;
         GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH  ;
-        if ( pin < 15 ) {
-            pintmp = pin;
-            GPIO_InitStruct.Pin = (1 << pintmp);
-            HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
-        } else if ( pin < 31 ) {
-            pintmp = pin-16;
-            GPIO_InitStruct.Pin = (1 << pintmp);
-            HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
-        } else if ( pin < 47 ) {
-            pintmp = pin-32;
-            GPIO_InitStruct.Pin = (1 << pintmp);
-            HAL_GPIO_Init(GPIOC, &GPIO_InitStruct);
-        } else if ( pin < 63 ) {
-            pintmp = pin-48;
-            GPIO_InitStruct.Pin = (1 << pintmp);
-            HAL_GPIO_Init(GPIOD, &GPIO_InitStruct);
-        }
+        pintmp = pin & 0xF;
+        GPIO_InitStruct.Pin = (1 << pintmp);
+        HAL_GPIO_Init(GpioPort ( pin ), &GPIO_InitStruct);
         switch ( pintmp ) {
             case 0 :
             case 1 :             
@@ -274,13 +198,13 @@ void  McuSTM32L0::Init_Irq ( PinName pin) {
     /******************************************************************************/
 /*                             Mcu LOwPower timer Api                         */
 /******************************************************************************/
-void McuSTM32L0::LowPowerTimerLoRaInit ( ) {
+void McuSTM32L0::LptimInit ( ) {
     /* Peripheral clock enable */
     RCC_PeriphCLKInitTypeDef PeriphClkInitStruct;
     PeriphClkInitStruct.PeriphClockSelection = RCC_PERIPHCLK_LPTIM1;
     PeriphClkInitStruct.LptimClockSelection = RCC_LPTIM1CLKSOURCE_LSE;
     if (HAL_RCCEx_PeriphCLKConfig(&PeriphClkInitStruct) != HAL_OK) {
-        DEBUG_MSG("PeriphClkInitStruct LPTIM failed with LSE\n");
+        MMLOG_ERROR(MCU, "PeriphClkInitStruct LPTIM failed with LSE\n");
     }
     __HAL_RCC_LPTIM1_CLK_ENABLE();
     hlptim1.Instance                 = LPTIM1;
@@ -297,26 +221,9 @@ void McuSTM32L0::LowPowerTimerLoRaInit ( ) {
     NVIC_DisableIRQ(LPTIM1_IRQn);
     //NVIC_SetVector(LPTIM1_IRQn, (uint32_t)LPTIM1_IRQHandler);
     NVIC_EnableIRQ(LPTIM1_IRQn);
-    Func = DoNothing;
-    obj = NULL;
-    //Initialize delay Systick timer for wait function
-    //TM_DELAY_Init();
 };
-/*!
- * LowPowerTimerLoRa AttachMsecond
- *
- * \param void (* _Func) (void *) a static method member of the current Obj
- * \param *_obj a pointer to the current objet
- * \param int delay in ms delay should be between 1ms and 16s.
- * \param [OUT] void         
- * \remark the code  Func =  _Func ; and obj  = _obj; isn't mcu dependent
- * \remark starts the LoRaWAN dedicated timer and attaches the IRQ to the handling Interupt SErvice Routine in the LoRaWAN object.
- */
-void McuSTM32L0::StartTimerMsecond ( void (* _Func) (void *) , void * _obj, int delay){
-    Func =  _Func ;
-    obj  = _obj;
-    int DelayMs2tick = delay * 2 + ( ( 6 * delay ) >> 7);
-    HAL_LPTIM_TimeOut_Start_IT(&hlptim1, 65535, DelayMs2tick); // MCU specific
+void McuSTM32L0::LptimStart ( uint32_t ticks ){
+    HAL_LPTIM_TimeOut_Start_IT(&hlptim1, 65535, ticks); // MCU specific
 };
 
 
@@ -333,17 +240,22 @@ void McuSTM32L0::UartInit ( void ) {
 
     if(HAL_UART_Init(&UartHandle) != HAL_OK)
     {
-        Error_Handler();
+        return;
     }
 #endif
 } 
 
+void McuSTM32L0::TraceFlush ( void ) {
+#if ( DEBUG_TRACE == 1 ) && ( BINARY_TRACE == 1 )
+    McuTraceFlush ( );
+#endif
+}
+
 void McuSTM32L0::MMprint( const char *fmt, ...) {
 #if DEBUG_TRACE == 1
   va_list argp;
   va_start(argp, fmt);
-  vprint(fmt, argp);
+  McuTracePrint(fmt, argp);
   va_end(argp);
 #endif
 }
-#endif
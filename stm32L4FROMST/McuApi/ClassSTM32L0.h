@@ -8,8 +8,10 @@
  |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___| 
                                                    
                                                    
-Description       : STM32L MCU .   
-                    Example of MCU class implementation based on stm32L4 + mbed library
+Description       : STM32L0 MCU .   
+                    Example of MCU class implementation based on stm32L0, selected by ApiMcu.h when the
+                    build defines MCU_STM32L0. The family independent part of the api is in McuCore.h.
+                    The Cortex-M0+ has no DWT : UserDefine.h sets PROFILE_ENABLE and ISR_STATS_ENABLE to 0.
 License           : Revised BSD License, see LICENSE.TXT file include in the project
 
 Maintainer        : Fabien Holin (SEMTECH)
@@ -19,10 +21,6 @@ Maintainer        : Fabien Holin (SEMTECH)
 
 #include "stdint.h"
 #include "stm32l0xx_hal.h"
-#include "stm32l0xx_ll_spi.h"
-#include "time.h"
-#include "Uart.h"
-#include "stdint.h"
 
 
 
@@ -36,7 +34,6 @@ Maintainer        : Fabien Holin (SEMTECH)
 
 
 
-static IWDG_HandleTypeDef Iwdg;
  extern "C" {
      void EXTI4_15_IRQHandler(void);
        void EXTI2_3_IRQHandler(void);
@@ -155,19 +152,17 @@ typedef enum {
     // Not connected
     NC = (int)0xFFFFFFFF
 } PinName;
+
+#include "McuCore.h"
 /********************************************************************/
 /*                        Gpio Handler  functions                   */
 /********************************************************************/
 
 static RTC_HandleTypeDef RtcHandle;
 
-class McuSTM32L0 {
+class McuSTM32L0 : public McuCore < McuSTM32L0 > {
 public :    
-    McuSTM32L0 ( PinName mosi, PinName miso, PinName sclk ) {
-        McuMosi = mosi;   // don't modify
-        McuMiso = miso;   // don't modify
-        McuSclk = sclk;   // don't modify
-    }     ;
+    McuSTM32L0 ( PinName mosi, PinName miso, PinName sclk ) : McuCore < McuSTM32L0 > ( mosi, miso, sclk ) { };
     ~McuSTM32L0 ( ){};
     void InitMcu ( void );
 
@@ -195,7 +190,7 @@ public :
         GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
         GPIO_InitStruct.Pull = GPIO_NOPULL;
         GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-        GPIO_InitStruct.Alternate = GPIO_PIN_5;
+        GPIO_InitStruct.Alternate = GPIO_AF0_SPI1;
         HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 
         hspi1.Instance = SPI1;
@@ -210,53 +205,10 @@ public :
         hspi1.Init.TIMode = SPI_TIMODE_DISABLE;
         hspi1.Init.CRCCalculation = SPI_CRCCALCULATION_DISABLE;
         hspi1.Init.CRCPolynomial = 7;
-        //hspi1.Init.CRCLength = SPI_CRC_LENGTH_DATASIZE;
-        //hspi1.Init.NSSPMode = SPI_NSS_PULSE_ENABLE;
         __HAL_SPI_DISABLE(&hspi1);
         HAL_SPI_Init(&hspi1);
         __HAL_SPI_ENABLE(&hspi1);
    };
-    /** Write to the SPI Slave and return the response
-    *
-    *  @param value Data to be sent to the SPI slave
-    *
-    *  @returns
-    *    Response from the SPI slave
-    */
-    uint8_t SpiWrite(int value) {
-        uint8_t rxData = 0;
-        while( LL_SPI_IsActiveFlag_TXE ( SPI1 ) == 0  ){};
-        LL_SPI_TransmitData8 (SPI1, uint8_t (value&0xFF));
-        while( LL_SPI_IsActiveFlag_RXNE ( SPI1 ) == 0 ){};
-        rxData =  LL_SPI_ReceiveData8( SPI1 );
-        return (rxData);
-    };
-    
-    /** Configure the data transmission format
-    *
-    *  @param bits Number of bits per SPI frame (4 - 16)
-    *  @param mode Clock polarity and phase mode (0 - 3)
-    *
-    * @code
-    * mode | POL PHA
-    * -----+--------
-    *   0  |  0   0
-    *   1  |  0   1
-    *   2  |  1   0
-    *   3  |  1   1
-    * @endcode
-    */
-    void Spiformat(int bits, int mode = 0) { } ;
-        
-    /** Set the spi bus clock frequency
-    *
-    *  @param hz SCLK frequency in hz (default = 1MHz)
-    */
-    void SetSpiFrequency(int hz = 1000000) { } ;
-    PinName McuMosi;
-    PinName McuMiso;
-    PinName McuSclk;
-    
     
 /******************************************************************************/
 /*                                Mcu RTC Api                                 */
@@ -264,15 +216,17 @@ public :
     /*!
     * RtcInit Function
     * \remark must be called before any call to initiliaze the timers
+    * \remark the calendar starts on the 1st of January 1970, the time 0 of McuCoreEpochSecond
     * \param [IN]   void
     * \param [OUT]  void       
     */
     void     RtcInit            ( void ){ 
 
         __HAL_RCC_RTC_ENABLE();
+        RtcHandle.Instance            = RTC;
         RtcHandle.Init.HourFormat     = RTC_HOURFORMAT_24;
         RtcHandle.Init.AsynchPrediv   = 127;
-        RtcHandle.Init.SynchPrediv    = 255;//(rtc_freq / 128 )-1 ;
+        RtcHandle.Init.SynchPrediv    = RtcSubSecondMax;//(rtc_freq / 128 )-1 ;
         RtcHandle.Init.OutPut         = RTC_OUTPUT_DISABLE;
         RtcHandle.Init.OutPutPolarity = RTC_OUTPUT_POLARITY_HIGH;
         RtcHandle.Init.OutPutType     = RTC_OUTPUT_TYPE_OPENDRAIN;
@@ -280,20 +234,15 @@ public :
             MMprint("RTC error: RTC initialization failed.");
         }
 
-        /*init time to 0*/
-        time_t t = 0;
-        struct tm * timeinfo ;
-        timeinfo = localtime (&t) ;
         RTC_DateTypeDef dateStruct;
         RTC_TimeTypeDef timeStruct;
-        // Fill RTC structures
-        dateStruct.WeekDay        = timeinfo->tm_wday;
-        dateStruct.Month          = timeinfo->tm_mon + 1;
-        dateStruct.Date           = timeinfo->tm_mday;
-        dateStruct.Year           = timeinfo->tm_year;
-        timeStruct.Hours          = timeinfo->tm_hour;
-        timeStruct.Minutes        = timeinfo->tm_min;
-        timeStruct.Seconds        = timeinfo->tm_sec;
+        dateStruct.WeekDay        = RTC_WEEKDAY_THURSDAY;
+        dateStruct.Month          = RTC_MONTH_JANUARY;
+        dateStruct.Date           = 1;
+        dateStruct.Year           = 70;
+        timeStruct.Hours          = 0;
+        timeStruct.Minutes        = 0;
+        timeStruct.Seconds        = 0;
         timeStruct.TimeFormat     = RTC_HOURFORMAT_24;
         timeStruct.DayLightSaving = RTC_DAYLIGHTSAVING_NONE;
         timeStruct.StoreOperation = RTC_STOREOPERATION_RESET;
@@ -302,82 +251,9 @@ public :
         HAL_RTC_SetTime(&RtcHandle, &timeStruct, FORMAT_BIN);
     };
     
-    /*!
-    * RtcGetTimeSecond : return the Current Rtc time in Second 
-    * \remark is used for :
-    * \remark scheduling autonomous retransmissions (for exemple NbTrans) , transmitting MAC answers , basically any delay without accurate time constraints
-    * \remark also used to measure the time spent inside the LoRaWAN process for the integrated failsafe
-    * \param [IN]   void
-    * \param [OUT]  uint32_t RTC time in Second       
-    */
-    uint32_t RtcGetTimeSecond       ( void ) {
-        RTC_DateTypeDef dateStruct;
-        RTC_TimeTypeDef timeStruct;
-        struct tm timeinfo;
-        RtcHandle.Instance = RTC;
-
-        HAL_RTC_GetTime(&RtcHandle, &timeStruct, FORMAT_BIN);
-        HAL_RTC_GetDate(&RtcHandle, &dateStruct, FORMAT_BIN);
-        timeinfo.tm_wday = dateStruct.WeekDay;
-        timeinfo.tm_mon  = dateStruct.Month ;
-        timeinfo.tm_mday = dateStruct.Date;
-        timeinfo.tm_year = dateStruct.Year ;
-        timeinfo.tm_hour = timeStruct.Hours;
-        timeinfo.tm_min  = timeStruct.Minutes;
-        timeinfo.tm_sec  = timeStruct.Seconds;
-        time_t t = mktime(&timeinfo);
-        return ( t );
-    };
-   /*!
-    * RtcGetTimeMs : return the Current Rtc time in Ms 
-    * \remark is used to timestamp radio events (end of TX), will also be used for future classB
-    * \remark this function may be used by the application.
-    * \param [IN]   void
-    * \param [OUT]  uint32_t Current RTC time in ms wraps every 49 days       
-    */
-    uint32_t RtcGetTimeMs  ( void ) {
-        RTC_DateTypeDef dateStruct;
-        RTC_TimeTypeDef timeStruct;
-        struct tm timeinfo;
-        RtcHandle.Instance = RTC;
-        HAL_RTC_GetTime(&RtcHandle, &timeStruct, FORMAT_BIN);
-        HAL_RTC_GetDate(&RtcHandle, &dateStruct, FORMAT_BIN);
-        timeinfo.tm_wday = dateStruct.WeekDay;
-        timeinfo.tm_mon  = dateStruct.Month ;
-        timeinfo.tm_mday = dateStruct.Date;
-        timeinfo.tm_year = dateStruct.Year ;
-        timeinfo.tm_hour = timeStruct.Hours;
-        timeinfo.tm_min  = timeStruct.Minutes;
-        timeinfo.tm_sec  = timeStruct.Seconds;
-        // Convert to timestamp
-        time_t t = mktime(&timeinfo);
-        return ( ( t * 1000 ) + ( 999 - ( ( timeStruct.SubSeconds *999) / 255 ) ) );  // get time en ms
-    };    
-    
-    
 /******************************************************************************/
 /*                                Mcu Flash Api                               */
 /******************************************************************************/
-     /** RestoreContext data from a flash device.  
-     * 
-     *  This method invokes memcpy - reads number of bytes from the address 
-     * 
-     *  @param buffer Buffer to write to 
-     *  @param addr   Flash address to begin reading from 
-     *  @param size   Size to read in bytes 
-     *  @return       0 on success, negative error code on failure 
-     */ 
-    int RestoreContext(uint8_t *buffer, uint32_t addr, uint32_t size){      
-        /* have to be implemented by mcu providers
-    the following code propose a lite implementation without any error cases*/
-    int i;
-    for (i=0;i<size;i++){
-        buffer[i]= *((uint8_t*)(addr)+i);
-    }
-     return 0;
-    };
-
- 
     /** StoreContext data to flash
      *  To be safer this function have to implement a read/check data sequence after programation 
      *  
@@ -388,121 +264,46 @@ public :
      *  @return       0 on success, negative error code on failure 
      */ 
     int StoreContext(const void *buffer, uint32_t addr, uint32_t size){  
-        HAL_StatusTypeDef res = HAL_OK; 
-        HAL_FLASH_Unlock(); 
-
-//        for (; size >= 4; size -= 4, addr += 4) { 
-//            res = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr, *(uint32_t const*)buffer); 
-//            buffer = (uint32_t const*)buffer + 1; 
-//            if (res != HAL_OK) 
-//            goto done; 
-//        } 
-        for (int i = 0 ; i < (8 * size ) ; i++){
-         *((uint8_t*)(addr)+i) = *((uint8_t *)(buffer) + i);
-         __WFI();
-    }
-        
-            HAL_FLASH_Lock(); 
-            return res == HAL_OK ? 0 : -1; 
+        return ( WriteFlashWithoutErase ( ( uint8_t * ) buffer, addr, 8 * size ) );
     }; 
+
+    /** WriteFlashWithoutErase : the data eeprom of the L0 is written byte per byte, without erase
+     * 
+     *  @param buffer Buffer of data to be written 
+     *  @param addr   Data eeprom address to begin writing to
+     *  @param size   Size to write in bytes 
+     *  @return       0 on success, negative error code on failure 
+     */ 
+    int WriteFlashWithoutErase(uint8_t *buffer, uint32_t addr, uint32_t size){
+        HAL_StatusTypeDef res = HAL_OK; 
+        HAL_FLASHEx_DATAEEPROM_Unlock ( );
+        for ( uint32_t i = 0 ; ( i < size ) && ( res == HAL_OK ) ; i++ ) {
+            if ( *( ( uint8_t * ) addr + i ) != buffer [ i ] ) { // an unchanged byte is not worn
+                res = HAL_FLASHEx_DATAEEPROM_Program ( FLASH_TYPEPROGRAMDATA_BYTE, addr + i, buffer [ i ] );
+            }
+        }
+        HAL_FLASHEx_DATAEEPROM_Lock ( );
+        return res == HAL_OK ? 0 : -1; 
+    };
         
 /******************************************************************************/
-/*                             Mcu WatchDog Api                               */
+/*                                Mcu Sleep Api                               */
 /******************************************************************************/
-    /* A function to init and start the Watchdog 
-    * \remark The expired period = WATCH_DOG_PERIOD_RELEASE seconds
-    * \param [IN]   void  
-    * \param [OUT]  void       
-    */
-    void WatchDogStart ( void ){
-    Iwdg.Instance = IWDG;
-    Iwdg.Init.Prescaler =  IWDG_PRESCALER_256;
-    Iwdg.Init.Window = IWDG_WINDOW_DISABLE;
-    Iwdg.Init.Reload = 0xFFF;
-    HAL_IWDG_Init(&Iwdg);
-} ;
-
-    /* A function to release the Watchdog 
-    * \remark Application have to call this function periodically (with a period <WATCH_DOG_PERIOD_RELEASE)
-    *         If not , the mcu will reset.
-    * \param [IN]   void  
-    * \param [OUT]  void       
-    */
-    void WatchDogRelease ( void ) {
-    HAL_IWDG_Refresh(&Iwdg);
-};
-    
-/******************************************************************************/
-/*                      Mcu Low Power Timer Api                               */
-/******************************************************************************/
-/*!
-    * LowPowerTimerLoRa Init
-    *\remark initializes the dedicated LoRaWAN low power timer object. MCU specific.
-    * \param [IN]  void
-    * \param [OUT] void         
-    */
-    void LowPowerTimerLoRaInit ( void );
-    /*!
-    * LowPowerTimerLoRa AttachMsecond
-    *
-    * \param void (* _Func) (void *) a static method member of the current Obj
-    * \param *_obj a pointer to the current objet
-    * \param int delay in ms delay should be between 1ms and 16s.
-    * \param [OUT] void         
-    * \remark the code  Func =  _Func ; and obj  = _obj; isn't mcu dependent , and could be keep as already implemented
-    * \remark starts the LoRaWAN dedicated timer and attaches the IRQ to the handling Interupt Service Routine in the LoRaWAN object.
-    */
-    void StartTimerMsecond     ( void (* _Func) (void *) , void * _obj, int delay) ;
-        
     /*!
-    *  timerISR
-    * \remark    Do Not Modify 
+    * A function to wait for delay milliseconds, the watchdog is released
+    * \remark no low power mode on this family yet, GotoSleepSecond is in McuCore
+    * \param [IN]   int delay 
+    * \param [OUT]  void       
     */
-    void timerISR              ( void ) { Func(obj); };
+    void GotoSleepMSecond ( int delay ) {
+        mwait_ms ( delay );
+        WatchDogRelease ( );
+    };
+
 /******************************************************************************/
 /*                           Mcu Gpio Api                                     */
 /******************************************************************************/
-    void SetValueDigitalOutPin ( PinName pin, int Value ) {
-        uint16_t pintmp ;
-        if ( pin < 15 ) {
-            pintmp = (uint16_t) pin;
-            HAL_GPIO_WritePin(GPIOA, ( 1 << pintmp ), (GPIO_PinState) Value);
-        } else  {
-            pintmp = (uint16_t)pin-16;
-            HAL_GPIO_WritePin(GPIOB, ( 1 << pintmp ), (GPIO_PinState) Value);
-        }
-    };
-    int  GetValueDigitalInPin  ( PinName pin ){
-        uint16_t pintmp;
-        if ( pin < 15 ) {
-            pintmp = (uint16_t) pin;
-            return ( (int) HAL_GPIO_ReadPin(GPIOA, ( 1 << pintmp ) ) );
-        } else  {
-            pintmp = (uint16_t) pin-16;
-            return ( (int) HAL_GPIO_ReadPin(GPIOB, ( 1 << pintmp ) ) );
-        }
-    };
     void Init_Irq ( PinName pin) ;
-    void AttachInterruptIn     (  void (* _Funcext) (void *) , void * _objext)  {
-        Funcext =  _Funcext ;
-        objext  = _objext;
-        userIt  = 0 ; 
-    };
-    void AttachInterruptIn     (  void (* _Funcext) ( void ) ) { 
-        _UserFuncext = _Funcext; userIt = 1 ; 
-    };
-    void DetachInterruptIn     (  void (* _Funcext) ( void ) ) { userIt = 0 ; };
-    /*!
-    *  ExtISR
-    * \remark    Do Not Modify 
-    */
-    void ExtISR                ( void ) { 
-        if (userIt == 0 ) { 
-        Funcext(objext); 
-        } else {
-        _UserFuncext ();
-        }; 
-    };
     
 /******************************************************************************/
 /*                           Mcu Wait Api                                     */
@@ -519,19 +320,25 @@ public :
 /******************************************************************************/
     void UartInit ( void );
     void MMprint( const char *fmt, ...);
-private :
     /*!
-    *  Low power timer
-    * \remark    Do Not Modify 
+    * TraceFlush : send the binary trace frames (MMTRACE) pending in the ring buffer
+    * \remark have to be called from the main loop when BINARY_TRACE is set, never from an ISR
     */
-    static void DoNothing (void *) { };
-    void (* Func) (void *);
-    void * obj;
-    void (* Funcext) (void *);
-    void * objext;
-    void (* _UserFuncext) ( void );
-    int userIt;
-    
+    void TraceFlush ( void );
+
+/******************************************************************************/
+/*                      Family hooks of McuCore                               */
+/******************************************************************************/
+    static void LptimStart ( uint32_t ticks ) ;
+    static void LptimInit  ( void ) ;
+    static void RtcRead    ( RTC_TimeTypeDef & time, RTC_DateTypeDef & date ) {
+        RtcHandle.Instance = RTC;
+        HAL_RTC_GetTime(&RtcHandle, &time, FORMAT_BIN);
+        HAL_RTC_GetDate(&RtcHandle, &date, FORMAT_BIN);
+    };
+    void        SleepSecond ( int duration ) { mwait ( duration ); }; // no low power mode yet
+    static constexpr uint32_t RtcSubSecondMax = 255;
+    static constexpr uint32_t UidAddress      = 0x1FF80050;
 };
 
 
@@ -18,7 +18,6 @@ Maintainer        : Fabien Holin (SEMTECH)
 #include "stdint.h"
 #include "ApiMcu.h"
 #include "stm32l4xx_hal.h"
-#include "time.h"
 #include "spi.h"
 #include "rtc.h"
 #include "gpio.h"
@@ -29,35 +28,26 @@ Maintainer        : Fabien Holin (SEMTECH)
 #include "wwdg.h"
 #include "iwdg.h"
 #include "UserDefine.h"
+#include "McuTrace.h"
+#include "McuLog.h"
+#include "McuConsole.h"
+#include "McuFault.h"
+#include "McuWatchDog.h"
+#include "McuIsrStats.h"
+#include "McuMemory.h"
+#include "McuEnergy.h"
+#include "McuSections.h"
+#include "McuVector.h"
+#include "McuPool.h"
+#include "McuPriority.h"
 #if DEBUG_TRACE == 1
     #include <stdarg.h>
     #include <string.h>
 #endif
-#define WATCH_DOG_PERIOD_RELEASE 30 // this period have to be lower than the Watch Dog period of 32 seconds
 
 
 
 
-__STATIC_INLINE uint32_t LL_SPI_IsActiveFlag_TXE(SPI_TypeDef *SPIx)
-{
-  return (READ_BIT(SPIx->SR, SPI_SR_TXE) == (SPI_SR_TXE));
-}
-
-__STATIC_INLINE void LL_SPI_TransmitData8(SPI_TypeDef *SPIx, uint8_t TxData)
-{
-  *((__IO uint8_t *)&SPIx->DR) = TxData;
-}
-
-__STATIC_INLINE uint32_t LL_SPI_IsActiveFlag_RXNE(SPI_TypeDef *SPIx)
-{
-  return (READ_BIT(SPIx->SR, SPI_SR_RXNE) == (SPI_SR_RXNE));
-}
-
-__STATIC_INLINE uint8_t LL_SPI_ReceiveData8(SPI_TypeDef *SPIx)
-{
-  return (uint8_t)(READ_REG(SPIx->DR));
-}
-
 /********************************************************************/
 /*                           Flash local functions                  */
 /********************************************************************/
@@ -249,7 +239,8 @@ HAL_StatusTypeDef FLASH_If_BankSwitch(void)
 }
 
 
-void FlashPageErase( uint32_t page, uint32_t banks )
+// run from SRAM2 : the busy wait does not stall on the flash being erased
+MCU_RAMFUNC void FlashPageErase( uint32_t page, uint32_t banks )
 {
     // Check the parameters
     assert_param( IS_FLASH_PAGE( page ) );
@@ -261,11 +252,16 @@ void FlashPageErase( uint32_t page, uint32_t banks )
     }
     // Proceed to erase the page
     MODIFY_REG( FLASH->CR, FLASH_CR_PNB, ( page << 3 ) );
+    McuEnergyConsumer( ENERGY_FLASH_ERASE, 1 );
     SET_BIT( FLASH->CR, FLASH_CR_PER );
     SET_BIT( FLASH->CR, FLASH_CR_STRT );
+    // wait here instead of in the next program to account the erase time
+    while ( READ_BIT( FLASH->SR, FLASH_SR_BSY ) != 0 ) {
+    }
+    McuEnergyConsumer( ENERGY_FLASH_ERASE, 0 );
 }
 
-uint8_t EepromMcuWriteBuffer( uint32_t addr, uint8_t *buffer, uint16_t size )
+MCU_RAMFUNC uint8_t EepromMcuWriteBuffer( uint32_t addr, uint8_t *buffer, uint16_t size )
 {   
     HAL_StatusTypeDef status = HAL_OK; 
     uint64_t *flash = ( uint64_t* )buffer;
@@ -276,6 +272,7 @@ uint8_t EepromMcuWriteBuffer( uint32_t addr, uint8_t *buffer, uint16_t size )
         FlashPageErase( Findpage + i, 1 );
     }
     WRITE_REG( FLASH->CR, 0x40000000 );
+    McuEnergyConsumer( ENERGY_FLASH_PROGRAM, 1 );
     for( uint32_t i = 0; i < size; i++ )
     {
         if (HAL_FLASH_Program( FLASH_TYPEPROGRAM_DOUBLEWORD, addr + ( 8 * i ), flash[i] ) == HAL_OK)
@@ -293,22 +290,11 @@ uint8_t EepromMcuWriteBuffer( uint32_t addr, uint8_t *buffer, uint16_t size )
             break;
         }
     }
+    McuEnergyConsumer( ENERGY_FLASH_PROGRAM, 0 );
     HAL_FLASH_Lock( );
     return status;
 }
 
-uint8_t EepromMcuReadBuffer( uint32_t addr, uint8_t *buffer, uint16_t size )
-{
-    assert_param( buffer != NULL ); 
-    //assert_param( addr >= DATA_EEPROM_BASE );
-    assert_param( buffer != NULL );
-    assert_param( size < ( DATA_EEPROM_END - DATA_EEPROM_BASE ) );
-    for( uint32_t i = 0; i < size; i++ ) {
-        buffer[i]= *((( uint8_t* )addr)+i);
-    }
-    return SUCCESS;
-}
-
 void EepromMcuSetDeviceAddr( uint8_t addr )
 {
     assert_param( FAIL );
@@ -381,40 +367,14 @@ void WakeUpAlarmSecond ( int delay) {
 /*                        Gpio Handler  functions                   */
 /********************************************************************/
 
-void  IrqHandlerRadio ( void ){
-    int pintmp = TX_RX_IT;
-    if ( pintmp < 15 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << pintmp) );
-    } else if ( pintmp < 31 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 16 )) );
-    } else if ( pintmp < 47 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 32 )) );
-    } else if ( pintmp < 63 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 48 )) );
-    } else if ( pintmp < 79 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 64 )) );
-    } else if ( pintmp < 95 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 80 )) );
-    } else if ( pintmp < 111 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 96 )) );
-    } 
-    pintmp = RX_TIMEOUT_IT;
-    if ( pintmp < 15 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << pintmp) );
-    } else if ( pintmp < 31 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 16 )) );
-    } else if ( pintmp < 47 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 32 )) );
-    } else if ( pintmp < 63 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 48 )) );
-    } else if ( pintmp < 79 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 64 )) );
-    } else if ( pintmp < 95 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 80 )) );
-    } else if ( pintmp < 111 ) {
-        HAL_GPIO_EXTI_IRQHandler( (1 << ( pintmp - 96 )) );
-    } 
-   
+// every EXTI vector enabled by Init_Irq lands here : EXTI0 to EXTI4, EXTI9_5 and EXTI15_10 (stm32l4xx_it.cpp)
+MCU_RAMFUNC void IrqHandlerRadio ( void ){
+    MMISR ( ISR_STAT_RADIO );
+    // the masks are folded by the compiler, no pin decoding left at run time
+    HAL_GPIO_EXTI_IRQHandler ( McuPin < Board::RadioIrq >::Mask );
+    if ( McuPin < Board::RxTimeoutIrq >::Mask != 0 ) {
+        HAL_GPIO_EXTI_IRQHandler ( McuPin < Board::RxTimeoutIrq >::Mask );
+    }
     mcu.ExtISR();
 }
 
@@ -424,12 +384,7 @@ void  IrqHandlerRadio ( void ){
 /*************************************************************/
 /*           Mcu Object Definition Constructor               */
 /*************************************************************/
-McuSTM32L4::McuSTM32L4(PinName mosi, PinName miso, PinName sclk )  {
-    Func = DoNothing; // don't modify
-    obj = NULL;       // don't modify
-    McuMosi = mosi;   // don't modify
-    McuMiso = miso;   // don't modify
-    McuSclk = sclk;   // don't modify
+McuSTM32L4::McuSTM32L4(PinName mosi, PinName miso, PinName sclk ) : McuCore < McuSTM32L4 > ( mosi, miso, sclk ) {
 }     
 McuSTM32L4::~McuSTM32L4(){
       // to be completed by mcu providers
@@ -440,11 +395,11 @@ McuSTM32L4::~McuSTM32L4(){
 /*******************************************/
 void McuSTM32L4::InitMcu( void ) {
     // system clk Done with mbed to be completed by mcu providers if mbed is removed
+  McuVectorInit(); // before HAL_Init starts the SysTick
       /* Reset of all peripherals, Initializes the Flash interface and the Systick. */
   HAL_Init();
 
   /* USER CODE BEGIN Init */
-
   /* USER CODE END Init */
 
   /* Configure the system clock */
@@ -456,12 +411,19 @@ void McuSTM32L4::InitMcu( void ) {
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  InitBoardGpio();
   MX_LPTIM1_Init();
   MX_USART2_UART_Init();
   MX_SPI1_Init();
   MX_RTC_Init();
  // MX_I2C1_Init();
-  //MX_WWDG_Init();
+#if WWDG_ENABLE == 1
+  MX_WWDG_Init();
+#endif
+  HAL_PWREx_EnableSRAM2ContentRetention(); // .sram2_noinit is kept in Standby
+  McuFaultInit();
+  McuIsrStatsInit();
+  McuEnergyInit();
   
   
   
@@ -477,27 +439,68 @@ void McuSTM32L4::InitMcu( void ) {
             */
     BankActive = READ_BIT(SYSCFG->MEMRMP, SYSCFG_MEMRMP_FB_MODE);
     if (BankActive == 0) { //bank 1
-        //DEBUG_MSG("Dual Boot is activated and code running on Bank 1 \n");
+        MMLOG_INFO(MCU, "Dual Boot is activated and code running on Bank 1 \n");
     } else {
-        //DEBUG_MSG("Dual Boot is activated and code running on Bank 2 \n");
+        MMLOG_INFO(MCU, "Dual Boot is activated and code running on Bank 2 \n");
         uint32_t result = FLASH_If_Erase( BankActive ); //Erase the 0x8080000
         if (result == FLASHIF_OK) {
-       // DEBUG_MSG("Copying BANK1 to BANK2\n");
+            MMLOG_INFO(FLASH, "Copying BANK1 to BANK2\n");
         result = FLASH_If_Write( FLASH_START_BANK2, (uint32_t*)FLASH_START_BANK1, 20480);
         }
         if (result != FLASHIF_OK) {
-         //   DEBUG_PRINTF("Failure! %d \n",result);
+            MMLOG_ERROR(FLASH, "Bank copy failure %d \n", result);
         } else {
-          //  DEBUG_MSG("Sucess!\n");
+            MMLOG_INFO(FLASH, "Bank copy success\n");
             FLASH_If_BankSwitch();
             NVIC_SystemReset();
         }
     }
 }
 
-void  McuSTM32L4::Init_Irq ( PinName pin) {
+void McuSTM32L4::InitBoardGpio ( void ) {
+    GPIO_InitTypeDef GPIO_InitStruct;
+    // Cs released before the pin is driven : no glitch selecting the radio
+    SetValueDigitalOutPin ( Board::Cs, 1 );
+    GPIO_InitStruct.Pin   = McuPin < Board::Cs >::Mask;
+    GPIO_InitStruct.Mode  = GPIO_MODE_OUTPUT_PP;
+    GPIO_InitStruct.Pull  = GPIO_NOPULL;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+    HAL_GPIO_Init ( ( GPIO_TypeDef * ) McuPin < Board::Cs >::PortBase, &GPIO_InitStruct );
+    GPIO_InitStruct.Pin   = McuPin < Board::Reset >::Mask;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+    HAL_GPIO_Init ( ( GPIO_TypeDef * ) McuPin < Board::Reset >::PortBase, &GPIO_InitStruct );
+    if ( Board::Busy != NC ) {
+        GPIO_InitStruct.Pin  = McuPin < Board::Busy >::Mask;
+        GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+        HAL_GPIO_Init ( ( GPIO_TypeDef * ) McuPin < Board::Busy >::PortBase, &GPIO_InitStruct );
+    }
+    Init_Irq ( Board::RadioIrq );
+    Init_Irq ( Board::RxTimeoutIrq );
+}
 
-}    
+void  McuSTM32L4::Init_Irq ( PinName pin) {
+    IRQn_Type IrqNum;
+    uint32_t line;
+    if ( pin == NC ) { // RX_TIMEOUT_IT of the sx126x board, on TX_RX_IT
+        return;
+    }
+    line = pin & 0xF;
+    GPIO_InitTypeDef GPIO_InitStruct;
+    GPIO_InitStruct.Pin   = ( 1U << line );
+    GPIO_InitStruct.Mode  = GPIO_MODE_IT_RISING;
+    GPIO_InitStruct.Pull  = GPIO_NOPULL;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+    HAL_GPIO_Init ( GpioPort ( pin ), &GPIO_InitStruct );
+    if ( line <= 4 ) {
+        IrqNum = ( IRQn_Type ) ( EXTI0_IRQn + line ); // EXTI0_IRQn to EXTI4_IRQn are contiguous
+    } else if ( line <= 9 ) {
+        IrqNum = EXTI9_5_IRQn;
+    } else {
+        IrqNum = EXTI15_10_IRQn;
+    }
+    HAL_NVIC_SetPriority ( IrqNum, NVIC_PRIORITY_RADIO, 0 );
+    HAL_NVIC_EnableIRQ ( IrqNum );
+}
 /******************************************************************************/
 /*                                Mcu Spi Api                                 */
 /******************************************************************************/
@@ -510,34 +513,11 @@ void  McuSTM32L4::Init_Irq ( PinName pin) {
 
 void McuSTM32L4::InitSpi ( ){
 
-}
-    /** Write to the SPI Slave and return the response
-    *
-    *  @param value Data to be sent to the SPI slave
-    *
-    *  @returns
-    *    Response from the SPI slave
-    */
-uint8_t McuSTM32L4::SpiWrite(int value){
-          uint8_t rxData = 0;
-        while( LL_SPI_IsActiveFlag_TXE ( SPI1 ) == 0  ){};
-        LL_SPI_TransmitData8 (SPI1, uint8_t (value&0xFF));
-        while( LL_SPI_IsActiveFlag_RXNE ( SPI1 ) == 0 ){};
-        rxData =  LL_SPI_ReceiveData8( SPI1 );
-        return (rxData);
 }
 /******************************************************************************/
 /*                                Mcu Flash Api                               */
 /******************************************************************************/
-int McuSTM32L4::RestoreContext(uint8_t *buffer, uint32_t addr, uint32_t size){
-     /* have to be implemented by mcu providers
-    the following code propose a lite implementation without any error cases*/
-    uint16_t sizet = size & 0xFFFF;
-    EepromMcuReadBuffer( addr, buffer, sizet );
-    return ( 0 ); 
-}
-static uint8_t copyPage [2048] ;
-int McuSTM32L4::WriteFlashWithoutErase(uint8_t *buffer, uint32_t addr, uint32_t size){
+MCU_RAMFUNC int McuSTM32L4::WriteFlashWithoutErase(uint8_t *buffer, uint32_t addr, uint32_t size){
 
     int findPage = 0 ;
     uint32_t findByteAdress = 0 ;
@@ -545,9 +525,14 @@ int McuSTM32L4::WriteFlashWithoutErase(uint8_t *buffer, uint32_t addr, uint32_t
     int status = 0;
     uint32_t i;
     uint32_t flashBaseAdress;    
+    uint8_t *copyPage = ( uint8_t* )McuPoolAlloc( 2048 );
     uint64_t *flash = ( uint64_t* )copyPage;
     assert_param( buffer != NULL );
     assert_param( size < ( 2048 ) );
+    if ( copyPage == NULL ) {
+        MMLOG_ERROR(FLASH, "WriteFlashWithoutErase no page buffer\n");
+        return ( -1 );
+    }
     findPage = ((addr - 0x8080000 )) >> 11 ;  // 2048 page size;
     findByteAdress = ( (addr - 0x8080000 )  - ( findPage << 11 ));
     findLastAdress = findByteAdress + size ; //if >2048 across two pages !!
@@ -559,6 +544,7 @@ int McuSTM32L4::WriteFlashWithoutErase(uint8_t *buffer, uint32_t addr, uint32_t
     }
     FlashPageErase(   findPage, 2 );
     WRITE_REG( FLASH->CR, 0x40000000 );
+    McuEnergyConsumer( ENERGY_FLASH_PROGRAM, 1 );
     if ( findLastAdress < 2048) { // all is done on the same page
         for( i = 0; i < size; i++ ) {
             copyPage[i + findByteAdress] = buffer [i];
@@ -576,8 +562,10 @@ int McuSTM32L4::WriteFlashWithoutErase(uint8_t *buffer, uint32_t addr, uint32_t
         for( i = 0; i < 2048; i++ ) { //copy the next page
             copyPage[i]= *(( uint8_t* )(flashBaseAdress + ((findPage + 1) * 2048))+i);
         }
+        McuEnergyConsumer( ENERGY_FLASH_PROGRAM, 0 );
         FlashPageErase(   1 + findPage, 2 );
         WRITE_REG( FLASH->CR, 0x40000000 );
+        McuEnergyConsumer( ENERGY_FLASH_PROGRAM, 1 );
         for( i = 0; i < (findLastAdress - 2048); i++ ) {
             copyPage[i ] =  buffer [i + 2048 - findByteAdress ];
         }
@@ -585,16 +573,19 @@ int McuSTM32L4::WriteFlashWithoutErase(uint8_t *buffer, uint32_t addr, uint32_t
             status += HAL_FLASH_Program( FLASH_TYPEPROGRAM_DOUBLEWORD, flashBaseAdress + ((findPage + 1) * 2048) + ( 8 * i ),  flash[i] );
         }
     }
+    McuEnergyConsumer( ENERGY_FLASH_PROGRAM, 0 );
     if ( status > 0 ) {
-        // DEBUG_MSG("ERROR HAL FLASH \n");
+        MMLOG_ERROR(FLASH, "WriteFlashWithoutErase HAL error %d \n", status);
     }
     HAL_FLASH_Lock( );
+    McuPoolFree( copyPage );
     return ( 0 ); 
 }
 
 
 
 int McuSTM32L4::StoreContext(const void *buffer, uint32_t addr, uint32_t size){
+    MMPROFILE ( "StoreContext" );
     /* have to be implemented by mcu providers
     the following code propose a lite implementation without any error cases
     this section have to be very robust, have to support failure mode such as  power off during flash programmation    
@@ -619,189 +610,71 @@ void McuSTM32L4::RtcInit (void)
 
 }
 
-uint32_t McuSTM32L4::RtcGetTimeMs( void )
+void McuSTM32L4::RtcRead ( RTC_TimeTypeDef & time, RTC_DateTypeDef & date )
 {
-    RTC_DateTypeDef dateStruct;
-    RTC_TimeTypeDef timeStruct;
-    struct tm timeinfo;
     RtcHandle.Instance = RTC;
-    HAL_RTC_GetTime(&RtcHandle, &timeStruct, FORMAT_BIN);
-    HAL_RTC_GetDate(&RtcHandle, &dateStruct, FORMAT_BIN);
-    timeinfo.tm_wday = dateStruct.WeekDay;
-    timeinfo.tm_mon  = dateStruct.Month ;
-    timeinfo.tm_mday = dateStruct.Date;
-    timeinfo.tm_year = dateStruct.Year ;
-    timeinfo.tm_hour = timeStruct.Hours;
-    timeinfo.tm_min  = timeStruct.Minutes;
-    timeinfo.tm_sec  = timeStruct.Seconds;
-    // Convert to timestamp
-    time_t t = mktime(&timeinfo);
-    return ( ( t * 1000 ) + ( 999 - ( ( timeStruct.SubSeconds *999) / 255 ) ) );  // get time en ms
-}
-
-uint32_t McuSTM32L4::RtcGetTimeSecond( void )
-{
-    RTC_DateTypeDef dateStruct;
-    RTC_TimeTypeDef timeStruct;
-    struct tm timeinfo;
-    RtcHandle.Instance = RTC;
-
-    HAL_RTC_GetTime(&RtcHandle, &timeStruct, FORMAT_BIN);
-    HAL_RTC_GetDate(&RtcHandle, &dateStruct, FORMAT_BIN);
-    timeinfo.tm_wday = dateStruct.WeekDay;
-    timeinfo.tm_mon  = dateStruct.Month ;
-    timeinfo.tm_mday = dateStruct.Date;
-    timeinfo.tm_year = dateStruct.Year ;
-    timeinfo.tm_hour = timeStruct.Hours;
-    timeinfo.tm_min  = timeStruct.Minutes;
-    timeinfo.tm_sec  = timeStruct.Seconds;
-    time_t t = mktime(&timeinfo);
-    return ( t );
+    // the time first : it locks the shadow registers until the date is read
+    HAL_RTC_GetTime(&RtcHandle, &time, FORMAT_BIN);
+    HAL_RTC_GetDate(&RtcHandle, &date, FORMAT_BIN);
 }
 
 /******************************************************************************/
 /*                                Mcu Sleep Api                               */
 /******************************************************************************/
-void McuSTM32L4::GotoSleepSecond (int duration ) {
+void McuSTM32L4::SleepSecond (int duration ) {
 #if LOW_POWER_MODE == 1
-    int cpt = duration ;
-    while ( cpt > ( WATCH_DOG_PERIOD_RELEASE ) ) {
-        cpt -= WATCH_DOG_PERIOD_RELEASE ;
-        WakeUpAlarmSecond( WATCH_DOG_PERIOD_RELEASE );
-        sleep();
-        WatchDogRelease ( );
-    }
-    WakeUpAlarmSecond( cpt );
+    WakeUpAlarmSecond( duration );
+    McuEnergyLowPowerEnter( ENERGY_STOP2 );
     sleep();
+    McuEnergyLowPowerExit( );
 # else
-    int cpt = duration ;
-    WatchDogRelease ( );
-    while ( cpt > ( WATCH_DOG_PERIOD_RELEASE ) ) {
-        cpt -= WATCH_DOG_PERIOD_RELEASE ;
-        mwait( WATCH_DOG_PERIOD_RELEASE );
-        WatchDogRelease ( );
-    }
-    mwait( cpt );
-    WatchDogRelease ( );
+    mwait( duration );
+    McuEnergyUpdate ( ); // a chunk is shorter than the 67 s wrap of the cycle counter
 #endif
 }
 
 void McuSTM32L4::GotoSleepMSecond (int duration ) {
 #if LOW_POWER_MODE == 1
     WakeUpAlarmMSecond ( duration );
+    McuEnergyLowPowerEnter( ENERGY_STOP2 );
     sleep();
+    McuEnergyLowPowerExit( );
     WatchDogRelease ( );
 # else
     mwait_ms ( duration ) ;
+    McuEnergyUpdate ( );
     WatchDogRelease ( );
 #endif
 }
 
 
 /******************************************************************************/
-/*                             Mcu WatchDog Api                               */
+/*                             Mcu Memory Api                                 */
 /******************************************************************************/
-
-static IWDG_HandleTypeDef Iwdg;
-
-/*!
- * Watch Dog Init And start with a period befor ereset set to 32 seconds
-*/
-void McuSTM32L4::WatchDogStart ( void ) {
- 
-}
-/*!
- * Watch Dog Release
-*/
-void McuSTM32L4::WatchDogRelease ( void ) {
-    HAL_IWDG_Refresh(&Iwdg);
+uint32_t McuSTM32L4::StackHighWaterMark ( void ) {
+    return ( McuStackHighWaterMark ( ) );
+};
+uint32_t McuSTM32L4::HeapPeak ( void ) {
+    return ( McuHeapPeak ( ) );
 };
 /******************************************************************************/
-/*                             Mcu LOwPower timer Api                         */
+/*                             Mcu Energy Api                                 */
 /******************************************************************************/
-void McuSTM32L4::LowPowerTimerLoRaInit ( ) {
-
-    Func = DoNothing;
-    obj = NULL;
-    //Initialize delay Systick timer for wait function
-    //TM_DELAY_Init();
+void McuSTM32L4::EnergyConsumer ( uint8_t state, int on ) {
+    McuEnergyConsumer ( state, on );
 };
-/*!
- * LowPowerTimerLoRa AttachMsecond
- *
- * \param void (* _Func) (void *) a static method member of the current Obj
- * \param *_obj a pointer to the current objet
- * \param int delay in ms delay should be between 1ms and 16s.
- * \param [OUT] void         
- * \remark the code  Func =  _Func ; and obj  = _obj; isn't mcu dependent
- * \remark starts the LoRaWAN dedicated timer and attaches the IRQ to the handling Interupt SErvice Routine in the LoRaWAN object.
- */
-void McuSTM32L4::StartTimerMsecond ( void (* _Func) (void *) , void * _obj, int delay){
-    Func =  _Func ;
-    obj  = _obj;
-    int DelayMs2tick = delay * 2 + ( ( 6 * delay ) >> 7);
-    HAL_LPTIM_TimeOut_Start_IT(&hlptim1, 65535, DelayMs2tick); // MCU specific
+void McuSTM32L4::EnergyUpdate ( void ) {
+    McuEnergyUpdate ( );
+};
+uint64_t McuSTM32L4::EnergyChargeNah ( void ) {
+    McuEnergyUpdate ( );
+    return ( McuEnergyChargeNah ( ) );
 };
-
 /******************************************************************************/
-/*                           Mcu Gpio Api                                     */
+/*                             Mcu LOwPower timer Api                         */
 /******************************************************************************/
-void McuSTM32L4::SetValueDigitalOutPin ( PinName Pin, int Value ){
-        uint16_t pintmp ;
-        if ( Pin < 15 ) {
-            pintmp = (uint16_t) Pin;
-            HAL_GPIO_WritePin(GPIOA, ( 1 << pintmp ), (GPIO_PinState) Value);
-        } else if ( Pin < 31 ) {
-            pintmp = (uint16_t)Pin-16;
-            HAL_GPIO_WritePin(GPIOB, ( 1 << pintmp ), (GPIO_PinState) Value);
-        } else if ( Pin < 47 ) {
-            pintmp = Pin-32;
-            HAL_GPIO_WritePin(GPIOC, ( 1 << pintmp ), (GPIO_PinState) Value);
-        } else if ( Pin < 63 ) {
-            pintmp = Pin-48;
-          HAL_GPIO_WritePin(GPIOD, ( 1 << pintmp ), (GPIO_PinState) Value);
-        } else if ( Pin < 79 ) {
-            pintmp = Pin-64;
-            HAL_GPIO_WritePin(GPIOE, ( 1 << pintmp ), (GPIO_PinState) Value);
-        } else if ( Pin < 95 ) {
-            pintmp = Pin-80;
-            HAL_GPIO_WritePin(GPIOF, ( 1 << pintmp ), (GPIO_PinState) Value);
-        } else  {
-            pintmp = Pin-96;
-            HAL_GPIO_WritePin(GPIOG, ( 1 << pintmp ), (GPIO_PinState) Value);
-        }
-};
-int McuSTM32L4::GetValueDigitalInPin ( PinName Pin ){
-    uint16_t pintmp ;
-    if ( Pin < 15 ) {
-        pintmp = (uint16_t) Pin;
-        return ( (int) HAL_GPIO_ReadPin(GPIOA, ( 1 << pintmp ) ) );
-    } else if ( Pin < 31 ) {
-        pintmp = (uint16_t)Pin-16;
-        return ( (int) HAL_GPIO_ReadPin(GPIOB, ( 1 << pintmp ) ) );
-    } else if ( Pin < 47 ) {
-        pintmp = Pin-32;
-       return ( (int) HAL_GPIO_ReadPin(GPIOC, ( 1 << pintmp ) ) );
-    } else if ( Pin < 63 ) {
-        pintmp = Pin-48;
-      return ( (int) HAL_GPIO_ReadPin(GPIOD, ( 1 << pintmp ) ) );
-    } else if ( Pin < 79 ) {
-        pintmp = Pin-64;
-        return ( (int) HAL_GPIO_ReadPin(GPIOE, ( 1 << pintmp ) ) );
-    } else if ( Pin < 95 ) {
-        pintmp = Pin-80;
-        return ( (int) HAL_GPIO_ReadPin(GPIOF, ( 1 << pintmp ) ) );
-    } else {
-        pintmp = Pin-96;
-        return ( (int) HAL_GPIO_ReadPin(GPIOG, ( 1 << pintmp ) ) );
-    }
-};
-
-
-void  McuSTM32L4::AttachInterruptIn       (  void (* _Funcext) (void *) , void * _objext) {
-    Funcext =  _Funcext ;
-    objext  = _objext;
-    userIt  = 0 ; 
+void McuSTM32L4::LptimStart ( uint32_t ticks ) {
+    HAL_LPTIM_TimeOut_Start_IT(&hlptim1, 65535, ticks); // MCU specific
 };
 
 /******************************************************************************/
@@ -810,29 +683,33 @@ void  McuSTM32L4::AttachInterruptIn       (  void (* _Funcext) (void *) , void *
 
  
 
-void vprint(const char *fmt, va_list argp)
-{
-#if DEBUG_TRACE == 1
-    char string[200];
-    if(0 < vsprintf(string,fmt,argp)) // build string
-    {
-        HAL_UART_Transmit(&huart2, (uint8_t*)string, strlen(string), 0xffffff); // send message via UART
-    }
-#endif
-}
-
-
-
 void McuSTM32L4::UartInit ( void ) {
-#if DEBUG_TRACE == 1
-  
+#if CONSOLE_ENABLE == 1
+    McuConsoleInit ( );
+#endif
+};
+void McuSTM32L4::ConsoleProcess ( void ) {
+#if CONSOLE_ENABLE == 1
+    McuConsoleProcess ( );
 #endif
 };
 void McuSTM32L4::MMprint( const char *fmt, ...){
 #if DEBUG_TRACE == 1
   va_list argp;
   va_start(argp, fmt);
-  vprint(fmt, argp);
+  McuTracePrint(fmt, argp);
   va_end(argp);
 #endif
 };
+int McuSTM32L4::SetUartBaud ( uint32_t baud ) {
+    TraceFlush ( );
+    return ( ( MX_USART2_SetBaudRate ( baud ) == HAL_OK ) ? 0 : -1 );
+};
+uint32_t McuSTM32L4::GetUartBaud ( void ) {
+    return ( huart2.Init.BaudRate );
+};
+void McuSTM32L4::TraceFlush( void ){
+#if ( DEBUG_TRACE == 1 ) && ( BINARY_TRACE == 1 )
+    McuTraceFlush();
+#endif
+};
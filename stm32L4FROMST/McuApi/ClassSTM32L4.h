@@ -10,6 +10,7 @@
                                                    
 Description       : STM32L4 MCU .   
                     Example of MCU class implementation based on stm32L4 + mbed library
+                    The family independent part of the api is in McuCore.h
 License           : Revised BSD License, see LICENSE.TXT file include in the project
 
 Maintainer        : Fabien Holin (SEMTECH)
@@ -131,12 +132,23 @@ typedef enum {
     NC = (int)0xFFFFFFFF
 } PinName;
 
+#include "McuCore.h"
 
-class McuSTM32L4 {
+
+class McuSTM32L4 : public McuCore < McuSTM32L4 > {
 public :    
      McuSTM32L4 ( PinName mosi, PinName miso, PinName sclk );
     ~McuSTM32L4 ( );
     void InitMcu ( void );
+    /*!
+    * InitBoardGpio : radio control lines of UserBoard.h, Cs high, Reset, Busy and the two radio interrupts
+    * \remark called by InitMcu after MX_GPIO_Init, that leaves these pins analog
+    */
+    void InitBoardGpio ( void );
+    /*!
+    * Init_Irq : pin as a rising edge EXTI input, its EXTI vector enabled at NVIC_PRIORITY_RADIO
+    * \remark NC is ignored (RxTimeoutIrq of the sx126x board)
+    */
     void Init_Irq ( PinName pin);
 /******************************************************************************/
 /*                                Mcu Spi Api                                 */
@@ -148,55 +160,9 @@ public :
     *  @param sclk SPI Clock pin
     */
     void InitSpi ( );
-    /** Write to the SPI Slave and return the response
-    *
-    *  @param value Data to be sent to the SPI slave
-    *
-    *  @returns
-    *    Response from the SPI slave
-    */
-    uint8_t SpiWrite(int value);
-    
-    /** Configure the data transmission format
-    *
-    *  @param bits Number of bits per SPI frame (4 - 16)
-    *  @param mode Clock polarity and phase mode (0 - 3)
-    *
-    * @code
-    * mode | POL PHA
-    * -----+--------
-    *   0  |  0   0
-    *   1  |  0   1
-    *   2  |  1   0
-    *   3  |  1   1
-    * @endcode
-    */
-    void Spiformat(int bits, int mode = 0) { } ;
-        
-    /** Set the spi bus clock frequency
-    *
-    *  @param hz SCLK frequency in hz (default = 1MHz)
-    */
-    void SetSpiFrequency(int hz = 1000000) { } ;
-    PinName McuMosi;
-    PinName McuMiso;
-    PinName McuSclk;
-
 /******************************************************************************/
 /*                                Mcu Flash Api                               */
 /******************************************************************************/
-     /** RestoreContext data from a flash device.  
-     * 
-     *  This method invokes memcpy - reads number of bytes from the address 
-     * 
-     *  @param buffer Buffer to write to 
-     *  @param addr   Flash address to begin reading from 
-     *  @param size   Size to read in bytes 
-     *  @return       0 on success, negative error code on failure 
-     */ 
-    int RestoreContext(uint8_t *buffer, uint32_t addr, uint32_t size);
-
- 
     /** StoreContext data to flash
      *  To be safer this function have to implement a read/check data sequence after programation 
      *  
@@ -232,35 +198,9 @@ public :
     */
     void     RtcInit            ( void ) ;
     
-    /*!
-    * RtcGetTimeSecond : return the Current Rtc time in Second 
-    * \remark is used for :
-    * \remark scheduling autonomous retransmissions (for exemple NbTrans) , transmitting MAC answers , basically any delay without accurate time constraints
-    * \remark also used to measure the time spent inside the LoRaWAN process for the integrated failsafe
-    * \param [IN]   void
-    * \param [OUT]  uint32_t RTC time in Second       
-    */
-    uint32_t RtcGetTimeSecond       ( void ) ;
-   /*!
-    * RtcGetTimeMs : return the Current Rtc time in Ms 
-    * \remark is used to timestamp radio events (end of TX), will also be used for future classB
-    * \remark this function may be used by the application.
-    * \param [IN]   void
-    * \param [OUT]  uint32_t Current RTC time in ms wraps every 49 days       
-    */
-    uint32_t RtcGetTimeMs  ( void ) ;
-    
 /******************************************************************************/
 /*                                Mcu Sleep Api                               */
 /******************************************************************************/
-    /*!
-    * A function to set the mcu in low power mode  for duration seconds
-    * \remark inside this function watchdog has to be manage to not reset the mcu
-    * \param [IN]   int delay 
-    * \param [OUT]  void       
-    */
-    void GotoSleepSecond (int duration ) ;
-    
         /*!
     * A function to set the mcu in low power mode  for duration in milliseconds
     * \remark 
@@ -269,73 +209,48 @@ public :
     */
     void     GotoSleepMSecond   ( int delay );
     
-/******************************************************************************/
-/*                             Mcu WatchDog Api                               */
-/******************************************************************************/
-    /* A function to init and start the Watchdog 
-    * \remark The expired period = WATCH_DOG_PERIOD_RELEASE seconds
-    * \param [IN]   void  
-    * \param [OUT]  void       
-    */
-    void WatchDogStart ( void ) ;
-
-    /* A function to release the Watchdog 
-    * \remark Application have to call this function periodically (with a period <WATCH_DOG_PERIOD_RELEASE)
-    *         If not , the mcu will reset.
-    * \param [IN]   void  
-    * \param [OUT]  void       
-    */
-    void WatchDogRelease ( void ) ;
-    
     
 /******************************************************************************/
-/*                             Mcu WatchDog Api                               */
+/*                           Mcu Memory Api                                   */
 /******************************************************************************/
-/*!
-    * LowPowerTimerLoRa Init
-    *\remark initializes the dedicated LoRaWAN low power timer object. MCU specific.
-    * \param [IN]  void
-    * \param [OUT] void         
-    */
-    void LowPowerTimerLoRaInit ( void );
     /*!
-    * LowPowerTimerLoRa AttachMsecond
-    *
-    * \param void (* _Func) (void *) a static method member of the current Obj
-    * \param *_obj a pointer to the current objet
-    * \param int delay in ms delay should be between 1ms and 16s.
-    * \param [OUT] void         
-    * \remark the code  Func =  _Func ; and obj  = _obj; isn't mcu dependent , and could be keep as already implemented
-    * \remark starts the LoRaWAN dedicated timer and attaches the IRQ to the handling Interupt Service Routine in the LoRaWAN object.
+    * StackHighWaterMark : deepest stack use since the reset
+    * \remark the stack area is painted by Reset_Handler, the search is a linear scan : not for an ISR
+    * \param [IN]   void
+    * \param [OUT]  uint32_t size in bytes, to compare with _Min_Stack_Size of the linker script
     */
-    void StartTimerMsecond     ( void (* _Func) (void *) , void * _obj, int delay) ;
-        
+    uint32_t StackHighWaterMark ( void ) ;
     /*!
-    *  timerISR
-    * \remark    Do Not Modify 
+    * HeapPeak : largest heap size reached through _sbrk since the reset
+    * \param [IN]   void
+    * \param [OUT]  uint32_t size in bytes, to compare with _Min_Heap_Size of the linker script
     */
-    void timerISR              ( void ) { Func(obj); };
+    uint32_t HeapPeak           ( void ) ;
 
 /******************************************************************************/
-/*                           Mcu Gpio Api                                     */
+/*                           Mcu Energy Api                                   */
 /******************************************************************************/
-    void SetValueDigitalOutPin ( PinName Pin, int Value );
-    int  GetValueDigitalInPin  ( PinName Pin );
-    void AttachInterruptIn     (  void (* _Funcext) (void *) , void * _objext) ;
-    void AttachInterruptIn     (  void (* _Funcext) ( void ) ) { _UserFuncext = _Funcext; userIt = 1 ; };
-    void DetachInterruptIn     (  void (* _Funcext) ( void ) ) { userIt = 0 ; };
     /*!
-    *  ExtISR
-    * \remark    Do Not Modify 
+    * EnergyConsumer : report a consumer drawing current on top of the mcu (see McuEnergy.h)
+    * \remark the radio driver reports ENERGY_RADIO_TX and ENERGY_RADIO_RX, can be called from an ISR
+    * \param [IN]   uint8_t state ENERGY_RADIO_TX, ENERGY_RADIO_RX, ENERGY_FLASH_ERASE or ENERGY_FLASH_PROGRAM
+    * \param [IN]   int on 1 when the consumer starts, 0 when it stops
+    * \param [OUT]  void
     */
-    void ExtISR                ( void ) { 
-        if (userIt == 0 ) { 
-        Funcext(objext); 
-        } else {
-        _UserFuncext ();
-        }; 
-    };
-    
+    void     EnergyConsumer     ( uint8_t state, int on ) ;
+    /*!
+    * EnergyUpdate : account the run time, have to be called at least every 60 seconds
+    * \param [IN]   void
+    * \param [OUT]  void
+    */
+    void     EnergyUpdate       ( void ) ;
+    /*!
+    * EnergyChargeNah : estimated charge drawn since the reset with the ENERGY_UA_xxx current table
+    * \param [IN]   void
+    * \param [OUT]  uint64_t charge in nAh
+    */
+    uint64_t EnergyChargeNah    ( void ) ;
+
 /******************************************************************************/
 /*                           Mcu wait                                         */
 /******************************************************************************/   
@@ -345,38 +260,51 @@ public :
 /******************************************************************************/
 /*                           Mcu Uart Api                                     */
 /******************************************************************************/
+    /*!
+    * UartInit : start the debug uart reception and the command console (CONSOLE_ENABLE)
+    * \remark the uart itself is initialized by MX_USART2_UART_Init
+    * \param [IN]   void
+    * \param [OUT]  void
+    */
     void UartInit ( void ) ;
     void MMprint( const char *fmt, ...);
-/*****************************************************************************/
-/*                                    Get Unique Id                          */
-/*****************************************************************************/
-
-    void GetUniqueId ( uint8_t  DevEui[8] ) {
-        const char* UID = (char*)0x1FFF7590;
-        uint32_t uid;
-        memcpy(&uid, UID, 4);
-        DevEui[7] =(uint8_t)(uid&0xff);
-        DevEui[6] =(uint8_t)((uid>>8)&0xFF);
-        DevEui[5] =(uint8_t)((uid>>16)&0xFF);
-        DevEui[4] =(uint8_t)((uid>>24)&0xFF);
-        memcpy(&uid, UID + 4, 4);
-        DevEui[3] =(uint8_t)(uid&0xFF);
-        DevEui[2] =(uint8_t)((uid>>8)&0xFF);
-        DevEui[1] =(uint8_t)((uid>>16)&0xFF);
-        DevEui[0] =(uint8_t)((uid>>24)&0xFF);
-    }
-private :
     /*!
-    *  Low power timer
-    * \remark    Do Not Modify 
+    * ConsoleProcess : run the commands received on the debug uart
+    * \remark have to be called from the main loop, never from an ISR
+    * \param [IN]   void
+    * \param [OUT]  void
+    */
+    void ConsoleProcess ( void );
+    /*!
+    * SetUartBaud : change the debug uart rate, BRR is recomputed from the live PCLK1
+    * \remark 8x oversampling is used above PCLK1/16, the highest rate is PCLK1/8
+    * \remark the pending trace frames are sent with the previous rate first
+    * \param [IN]   uint32_t baud rate in bauds
+    * \param [OUT]  int 0 on success, -1 if the rate can't be reached with the current PCLK1
+    */
+    int SetUartBaud ( uint32_t baud );
+    uint32_t GetUartBaud ( void );
+    /*!
+    * TraceFlush : send the binary trace frames (MMTRACE) pending in the ring buffer
+    * \remark have to be called from the main loop when BINARY_TRACE is set, never from an ISR
+    * \param [IN]   void
+    * \param [OUT]  void
     */
-    static void DoNothing (void *) { };
-    void (* Func) (void *);
-    void * obj;
-    void (* Funcext) (void *);
-    void * objext;
-    void (* _UserFuncext) ( void );
-    int userIt;
+    void TraceFlush ( void );
+/******************************************************************************/
+/*                      Family hooks of McuCore                               */
+/******************************************************************************/
+    static void LptimStart ( uint32_t ticks ) ;
+    static void LptimInit  ( void ) { } ; // done by MX_LPTIM1_Init
+    static void RtcRead    ( RTC_TimeTypeDef & time, RTC_DateTypeDef & date ) ;
+    void        SleepSecond ( int duration ) ;                // Stop 2 with LOW_POWER_MODE, mwait otherwise
+    static constexpr uint32_t RtcSubSecondMax = 255;         // SynchPrediv of MX_RTC_Init
+    static constexpr uint32_t UidAddress      = 0x1FFF7590;
 };
 
+/*!
+ * IrqHandlerRadio : shared body of the EXTI vectors of Board::RadioIrq and Board::RxTimeoutIrq
+ */
+void IrqHandlerRadio ( void );
+
 #endif
@@ -0,0 +1,339 @@
+/*
+ __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Debug uart command console.
+
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#include "McuConsole.h"
+#include "ApiMcu.h"
+#include "McuLog.h"
+#include "McuTrace.h"
+#include "McuFault.h"
+#include "McuWatchDog.h"
+#include "McuProfile.h"
+#include "McuIsrStats.h"
+#include "McuMemory.h"
+#include "McuEnergy.h"
+#include "McuSections.h"
+#include "McuPool.h"
+#include "McuEvent.h"
+#include "McuTask.h"
+#include "UserDefine.h"
+#include "usart.h"
+#include "stdlib.h"
+#include "string.h"
+
+#if ( CONSOLE_RX_BUFFER_SIZE & ( CONSOLE_RX_BUFFER_SIZE - 1 ) ) != 0
+    #error "CONSOLE_RX_BUFFER_SIZE have to be a power of 2"
+#endif
+
+// flash and store only reach the lorawan context page : StoreContext erases the whole page it writes
+#define CONSOLE_FLASH_START      USERFLASHADRESS
+#define CONSOLE_FLASH_END        ( USERFLASHADRESS + FLASH_PAGE_SIZE )
+#define CONSOLE_STORE_MAX_DWORDS 32
+
+typedef struct {
+    const char *      Name;
+    const char *      Help;
+    McuConsoleHandler Handler;
+} ConsoleCommand_t;
+
+MCU_SRAM2_BSS static uint8_t ConsoleRx [ CONSOLE_RX_BUFFER_SIZE ]; // written by the DMA
+static char              ConsoleLine [ CONSOLE_LINE_MAX + 1 ]; // only used when a line wraps around ConsoleRx
+static uint32_t          ConsoleRead = 0;
+static uint32_t          ConsoleLineStart = 0;
+static uint32_t          ConsoleLineLength = 0;
+static volatile uint32_t ConsoleEvent = 0;
+static uint32_t          ConsoleRxBytes = 0;
+static uint32_t          ConsoleLines = 0;
+static uint32_t          ConsoleDiscarded = 0;
+static volatile uint32_t ConsoleRxErrors = 0;
+static int               ConsoleStarted = 0;
+static ConsoleCommand_t  ConsoleCommands [ CONSOLE_MAX_COMMANDS ];
+static int               ConsoleCommandNumber = 0;
+
+/********************************************************************/
+/*                      Built-in commands                           */
+/********************************************************************/
+static void ConsoleHelp ( int argc, char * argv [ ] ) {
+    for ( int i = 0; i < ConsoleCommandNumber; i++ ) {
+        mcu.MMprint ( "%-8s %s\n", ConsoleCommands [ i ].Name, ConsoleCommands [ i ].Help );
+    }
+}
+
+static void ConsoleStats ( int argc, char * argv [ ] ) {
+    mcu.MMprint ( "uptime %lu ms\n", ( unsigned long ) HAL_GetTick ( ) );
+    mcu.MMprint ( "console rx %lu bytes, %lu lines, %lu discarded, %lu uart errors\n",
+                  ( unsigned long ) ConsoleRxBytes, ( unsigned long ) ConsoleLines,
+                  ( unsigned long ) ConsoleDiscarded, ( unsigned long ) ConsoleRxErrors );
+    mcu.MMprint ( "trace dropped %lu frames\n", ( unsigned long ) McuTraceDropped ( ) );
+    McuEventPrint ( );
+}
+
+static int ConsoleFlashRange ( uint32_t addr, uint32_t size ) {
+    return ( ( addr >= CONSOLE_FLASH_START ) && ( addr < CONSOLE_FLASH_END ) && ( size <= ( CONSOLE_FLASH_END - addr ) ) );
+}
+
+static void ConsoleFlash ( int argc, char * argv [ ] ) {
+    uint32_t addr = ( argc > 1 ) ? strtoul ( argv [ 1 ], NULL, 0 ) : USERFLASHADRESS;
+    uint32_t size = ( argc > 2 ) ? strtoul ( argv [ 2 ], NULL, 0 ) : 64;
+    if ( ConsoleFlashRange ( addr, size ) == 0 ) {
+        mcu.MMprint ( "address out of the context page %08lx..%08lx\n", ( unsigned long ) CONSOLE_FLASH_START, ( unsigned long ) ( CONSOLE_FLASH_END - 1 ) );
+        return;
+    }
+    uint8_t line [ 16 ];
+    for ( uint32_t offset = 0; offset < size; offset += 16 ) {
+        uint32_t length = ( ( size - offset ) < 16 ) ? ( size - offset ) : 16;
+        mcu.RestoreContext ( line, addr + offset, length );
+        mcu.MMprint ( "%08lx:", ( unsigned long ) ( addr + offset ) );
+        for ( uint32_t i = 0; i < length; i++ ) {
+            mcu.MMprint ( " %02x", line [ i ] );
+        }
+        mcu.MMprint ( "\n" );
+    }
+}
+
+static void ConsoleStore ( int argc, char * argv [ ] ) {
+    static uint64_t context [ CONSOLE_STORE_MAX_DWORDS ];
+    uint32_t addr    = ( argc > 1 ) ? strtoul ( argv [ 1 ], NULL, 0 ) : USERFLASHADRESS;
+    uint32_t dwords  = ( argc > 2 ) ? strtoul ( argv [ 2 ], NULL, 0 ) : 8;
+    if ( ( dwords == 0 ) || ( dwords > CONSOLE_STORE_MAX_DWORDS ) || ( ConsoleFlashRange ( addr, 8 * dwords ) == 0 ) || ( ( addr & 7 ) != 0 ) ) {
+        mcu.MMprint ( "usage : store <8 bytes aligned address in the context page %08lx..%08lx> <1..%d double words>\n",
+                      ( unsigned long ) CONSOLE_FLASH_START, ( unsigned long ) ( CONSOLE_FLASH_END - 1 ), CONSOLE_STORE_MAX_DWORDS );
+        return;
+    }
+    // store back the current content : exercises the full erase / program / check sequence
+    mcu.RestoreContext ( ( uint8_t * ) context, addr, 8 * dwords );
+    uint32_t start = HAL_GetTick ( );
+    int status = mcu.StoreContext ( context, addr, dwords );
+    mcu.MMprint ( "StoreContext %d in %lu ms\n", status, ( unsigned long ) ( HAL_GetTick ( ) - start ) );
+}
+
+static void ConsoleLog ( int argc, char * argv [ ] ) {
+    if ( argc == 3 ) {
+        int module = McuLogFindModule ( argv [ 1 ] );
+        int level  = -1;
+        for ( int i = LOG_LEVEL_NONE; i <= LOG_LEVEL_TRACE; i++ ) {
+            if ( strcmp ( argv [ 2 ], McuLogLevelName ( i ) ) == 0 ) {
+                level = i;
+            }
+        }
+        if ( McuLogSetLevel ( module, level ) != 0 ) {
+            mcu.MMprint ( "usage : log <module> <none|error|warn|info|debug|trace>\n" );
+            return;
+        }
+    }
+    for ( int i = 0; i < LOG_MODULE_NUMBER; i++ ) {
+        mcu.MMprint ( "%-6s %s\n", McuLogModuleName ( i ), McuLogLevelName ( McuLogGetLevel ( i ) ) );
+    }
+}
+
+static void ConsoleBaud ( int argc, char * argv [ ] ) {
+    if ( argc > 1 ) {
+        uint32_t baud = strtoul ( argv [ 1 ], NULL, 0 );
+        mcu.MMprint ( "switching to %lu bauds\n", ( unsigned long ) baud );
+        if ( mcu.SetUartBaud ( baud ) != 0 ) {
+            mcu.MMprint ( "%lu bauds is out of range\n", ( unsigned long ) baud );
+        }
+    }
+    mcu.MMprint ( "uart %lu bauds, pclk1 %lu Hz\n", ( unsigned long ) mcu.GetUartBaud ( ), ( unsigned long ) HAL_RCC_GetPCLK1Freq ( ) );
+}
+
+static void ConsoleFault ( int argc, char * argv [ ] ) {
+    if ( ( argc > 1 ) && ( strcmp ( argv [ 1 ], "clear" ) == 0 ) ) {
+        McuFaultClear ( );
+        return;
+    }
+    McuFaultPrint ( );
+}
+
+static void ConsoleWatchDog ( int argc, char * argv [ ] ) {
+    McuWatchDogPrint ( );
+}
+
+static void ConsoleProfile ( int argc, char * argv [ ] ) {
+    if ( ( argc > 1 ) && ( strcmp ( argv [ 1 ], "reset" ) == 0 ) ) {
+        McuProfileReset ( );
+        return;
+    }
+    McuProfilePrint ( );
+}
+
+static void ConsoleIsr ( int argc, char * argv [ ] ) {
+    if ( ( argc > 1 ) && ( strcmp ( argv [ 1 ], "reset" ) == 0 ) ) {
+        McuIsrStatsReset ( );
+        return;
+    }
+    McuIsrStatsPrint ( );
+}
+
+static void ConsoleMemory ( int argc, char * argv [ ] ) {
+    McuMemoryPrint ( );
+    McuPoolPrint ( );
+}
+
+static void ConsoleEnergy ( int argc, char * argv [ ] ) {
+    McuEnergyPrint ( );
+}
+
+static void ConsoleTask ( int argc, char * argv [ ] ) {
+    McuTaskPrint ( );
+}
+
+/********************************************************************/
+/*                          Line parser                             */
+/********************************************************************/
+static void ConsoleExecute ( char * line ) {
+    char * argv [ CONSOLE_MAX_ARGS ];
+    int    argc = 0;
+    while ( ( *line != '\0' ) && ( argc < CONSOLE_MAX_ARGS ) ) {
+        while ( *line == ' ' ) {
+            *line++ = '\0';
+        }
+        if ( *line == '\0' ) {
+            break;
+        }
+        argv [ argc++ ] = line;
+        while ( ( *line != ' ' ) && ( *line != '\0' ) ) {
+            line++;
+        }
+    }
+    if ( argc == 0 ) {
+        return;
+    }
+    for ( int i = 0; i < ConsoleCommandNumber; i++ ) {
+        if ( strcmp ( argv [ 0 ], ConsoleCommands [ i ].Name ) == 0 ) {
+            ConsoleCommands [ i ].Handler ( argc, argv );
+            return;
+        }
+    }
+    mcu.MMprint ( "unknown command %s, try help\n", argv [ 0 ] );
+}
+
+static void ConsoleDispatchLine ( uint32_t start, uint32_t length ) {
+    char * line;
+    if ( ( start + length ) < CONSOLE_RX_BUFFER_SIZE ) {
+        // the end of line byte has already been read : the DMA will not write it again before a full turn
+        line = ( char * ) &ConsoleRx [ start ];
+        line [ length ] = '\0';
+    } else {
+        for ( uint32_t i = 0; i < length; i++ ) {
+            ConsoleLine [ i ] = ( char ) ConsoleRx [ ( start + i ) & ( CONSOLE_RX_BUFFER_SIZE - 1 ) ];
+        }
+        ConsoleLine [ length ] = '\0';
+        line = ConsoleLine;
+    }
+    ConsoleLines++;
+    ConsoleExecute ( line );
+}
+
+/********************************************************************/
+/*                              Api                                 */
+/********************************************************************/
+void McuConsoleInit ( void ) {
+#if CONSOLE_ENABLE == 1
+    if ( ConsoleStarted == 1 ) {
+        return;
+    }
+    McuConsoleRegister ( "help",  "list the commands", ConsoleHelp );
+    McuConsoleRegister ( "stats", "uptime, console, trace and event queue counters", ConsoleStats );
+    McuConsoleRegister ( "flash", "[addr] [size] dump the lorawan context page", ConsoleFlash );
+    McuConsoleRegister ( "store", "[addr] [dwords] run StoreContext on the current context page content", ConsoleStore );
+    McuConsoleRegister ( "log",   "[module level] show or change the log levels", ConsoleLog );
+    McuConsoleRegister ( "baud",  "[rate] show or change the debug uart rate", ConsoleBaud );
+    McuConsoleRegister ( "fault", "[clear] print or forget the last crash dump", ConsoleFault );
+    McuConsoleRegister ( "wdog",  "print the tasks supervised by the watchdog", ConsoleWatchDog );
+    McuConsoleRegister ( "prof",  "[reset] print or clear the MMPROFILE probes", ConsoleProfile );
+    McuConsoleRegister ( "isr",   "[reset] print or clear the interrupt histograms", ConsoleIsr );
+    McuConsoleRegister ( "mem",   "print the stack, heap and pool peaks", ConsoleMemory );
+    McuConsoleRegister ( "energy", "print the time and charge per power state", ConsoleEnergy );
+    McuConsoleRegister ( "task",  "print the main loop tasks and the pending signals", ConsoleTask );
+    if ( HAL_UART_Receive_DMA ( &huart2, ConsoleRx, CONSOLE_RX_BUFFER_SIZE ) != HAL_OK ) {
+        MMLOG_ERROR ( MCU, "console : uart dma reception failed\n" );
+        return;
+    }
+    __HAL_UART_CLEAR_IDLEFLAG ( &huart2 );
+    __HAL_UART_ENABLE_IT ( &huart2, UART_IT_IDLE );
+    ConsoleStarted = 1;
+#endif
+}
+
+int McuConsoleRegister ( const char * name, const char * help, McuConsoleHandler handler ) {
+    if ( ConsoleCommandNumber >= CONSOLE_MAX_COMMANDS ) {
+        return ( -1 );
+    }
+    ConsoleCommands [ ConsoleCommandNumber ].Name    = name;
+    ConsoleCommands [ ConsoleCommandNumber ].Help    = help;
+    ConsoleCommands [ ConsoleCommandNumber ].Handler = handler;
+    ConsoleCommandNumber++;
+    return ( 0 );
+}
+
+int McuConsolePending ( void ) {
+    return ( ConsoleEvent != 0 );
+}
+
+void McuConsoleProcess ( void ) {
+    if ( ConsoleStarted == 0 ) {
+        return;
+    }
+    ConsoleEvent = 0;
+    uint32_t head = ( CONSOLE_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER ( huart2.hdmarx ) ) & ( CONSOLE_RX_BUFFER_SIZE - 1 );
+    while ( ConsoleRead != head ) {
+        uint8_t data = ConsoleRx [ ConsoleRead ];
+        ConsoleRead = ( ConsoleRead + 1 ) & ( CONSOLE_RX_BUFFER_SIZE - 1 );
+        ConsoleRxBytes++;
+        if ( ( data == '\r' ) || ( data == '\n' ) ) {
+            if ( ConsoleLineLength > CONSOLE_LINE_MAX ) {
+                ConsoleDiscarded++;
+            } else if ( ConsoleLineLength > 0 ) {
+                ConsoleDispatchLine ( ConsoleLineStart, ConsoleLineLength );
+            }
+            ConsoleLineStart  = ConsoleRead;
+            ConsoleLineLength = 0;
+        } else {
+            ConsoleLineLength++;
+        }
+    }
+}
+
+void McuConsoleRxEvent ( void ) {
+    ConsoleEvent = 1;
+}
+
+void McuConsoleUartIrq ( void ) {
+    uint32_t isr = huart2.Instance->ISR;
+    if ( ( isr & USART_ISR_IDLE ) != 0 ) {
+        __HAL_UART_CLEAR_IDLEFLAG ( &huart2 );
+        McuConsoleRxEvent ( );
+    }
+    if ( ( isr & ( USART_ISR_ORE | USART_ISR_FE | USART_ISR_NE | USART_ISR_PE ) ) != 0 ) {
+        __HAL_UART_CLEAR_FLAG ( &huart2, UART_CLEAR_OREF | UART_CLEAR_FEF | UART_CLEAR_NEF | UART_CLEAR_PEF );
+        ConsoleRxErrors++;
+    }
+}
+
+/********************************************************************/
+/*                    HAL DMA reception callbacks                   */
+/********************************************************************/
+void HAL_UART_RxHalfCpltCallback ( UART_HandleTypeDef * huart ) {
+    if ( huart->Instance == USART2 ) {
+        McuConsoleRxEvent ( );
+    }
+}
+
+void HAL_UART_RxCpltCallback ( UART_HandleTypeDef * huart ) {
+    if ( huart->Instance == USART2 ) {
+        McuConsoleRxEvent ( );
+    }
+}
@@ -0,0 +1,65 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Debug uart command console.
+                    USART2 receives in a circular DMA buffer, the idle line and the DMA half/full
+                    transfer interrupts only wake up the main loop : there is no interrupt per byte.
+                    Lines are parsed in place inside the DMA buffer, a line is only copied when it
+                    wraps around the end of the buffer.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_CONSOLE_H
+#define MCU_CONSOLE_H
+#include "stdint.h"
+
+#define CONSOLE_MAX_ARGS     6
+#define CONSOLE_MAX_COMMANDS 16
+
+/*!
+ * Command handler, argv [ 0 ] is the command name
+ */
+typedef void ( * McuConsoleHandler ) ( int argc, char * argv [ ] );
+
+/*!
+ * McuConsoleInit : start the DMA reception and register the built-in commands
+ * \remark help, stats, flash, store, log, baud, fault, wdog, prof, isr, mem and energy
+ */
+void     McuConsoleInit       ( void );
+
+/*!
+ * McuConsoleProcess : parse the received lines and run the commands
+ * \remark have to be called from the main loop, never from an ISR
+ */
+void     McuConsoleProcess    ( void );
+
+/*!
+ * McuConsoleRegister : add a command to the console
+ * \param [IN]  const char *      name     command name, the string is not copied
+ * \param [IN]  const char *      help     one line help, the string is not copied
+ * \param [IN]  McuConsoleHandler handler
+ * \param [OUT] int 0 on success, -1 if the command table is full
+ */
+int      McuConsoleRegister   ( const char * name, const char * help, McuConsoleHandler handler );
+
+/*!
+ * McuConsolePending : at least one idle line or DMA event since the last McuConsoleProcess
+ */
+int      McuConsolePending    ( void );
+
+/*!
+ * Interrupt entry points, called by USART2_IRQHandler and the HAL DMA callbacks
+ */
+void     McuConsoleUartIrq    ( void );
+void     McuConsoleRxEvent    ( void );
+
+#endif
@@ -0,0 +1,358 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Part of the Mcu api shared by the STM32 families (ClassSTM32L4, ClassSTM32L0).
+                    A family class derives from McuCore < itself > and provides the register level hooks :
+                        static void     LptimStart ( uint32_t ticks )   start the LoRaWAN timer, 2048 Hz ticks
+                        static void     LptimInit  ( void )             reconfigure it, can be empty
+                        static void     RtcRead    ( RTC_TimeTypeDef & time, RTC_DateTypeDef & date )
+                        static uint32_t RtcSubSecondMax                 RTC PREDIV_S
+                        static uint32_t UidAddress                      96 bits unique id
+                        void     SleepSecond ( int duration )           sleep or wait, at most WATCH_DOG_PERIOD_RELEASE s
+                    The family HAL and its PinName have to be included before this file.
+                    The spi, gpio and time methods are defined here, in the class declaration : they are
+                    inlined in the callers on every family. The watchdog and the long sleeps are shared too,
+                    both families use the task supervisor of McuWatchDog.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_CORE_H
+#define MCU_CORE_H
+#include "stdint.h"
+#include "string.h"
+#include "UserDefine.h"
+#include "McuEvent.h"
+#include "McuProfile.h"
+#include "McuWatchDog.h"
+#include "McuSections.h"
+
+/*!
+ * McuPin : compile time decoding of a PinName
+ * \remark Mask and PortBase are 0 for NC, PortBase is the GPIO port registers address
+ */
+template < PinName Pin > struct McuPin {
+    static constexpr uint32_t Line     = ( Pin == NC ) ? 0 : ( Pin & 0xF );
+    static constexpr uint32_t Mask     = ( Pin == NC ) ? 0 : ( 1U << Line );
+    static constexpr uint32_t PortBase = ( Pin == NC ) ? 0 : GPIOA_BASE + ( ( Pin >> 4 ) & 0xF ) * ( GPIOB_BASE - GPIOA_BASE );
+};
+
+/*!
+ * McuCoreEpochSecond : seconds since 1970 of an RTC calendar date, the RTC year 70 to 99 is 1970 to 1999,
+ *                      0 to 69 is 2000 to 2069
+ * \remark replaces mktime : no time zone, no struct tm normalization, a few multiplications
+ */
+static inline uint32_t McuCoreEpochSecond ( uint32_t year, uint32_t month, uint32_t date, uint32_t hours, uint32_t minutes, uint32_t seconds ) {
+    static const uint16_t DaysBeforeMonth [ 12 ] = { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 };
+    uint32_t fullYear = ( year >= 70 ) ? 1900 + year : 2000 + year;
+    uint32_t days = ( fullYear - 1970 ) * 365 + ( ( fullYear - 1969 ) / 4 ) - ( ( fullYear - 1901 ) / 100 ) + ( ( fullYear - 1601 ) / 400 );
+    days += DaysBeforeMonth [ ( month - 1 ) % 12 ] + date - 1;
+    if ( ( month > 2 ) && ( ( fullYear % 4 ) == 0 ) && ( ( ( fullYear % 100 ) != 0 ) || ( ( fullYear % 400 ) == 0 ) ) ) {
+        days++;
+    }
+    return ( ( ( days * 24 + hours ) * 60 + minutes ) * 60 + seconds );
+}
+
+template < class Family >
+class McuCore {
+public :
+    McuCore ( PinName mosi, PinName miso, PinName sclk ) : McuMosi ( mosi ), McuMiso ( miso ), McuSclk ( sclk ),
+        Func ( DoNothing ), obj ( NULL ), Funcext ( DoNothing ), objext ( NULL ), _UserFuncext ( NULL ), userIt ( 0 ) { };
+/******************************************************************************/
+/*                                Mcu Spi Api                                 */
+/******************************************************************************/
+    /** Write to the SPI Slave and return the response
+    *
+    *  @param value Data to be sent to the SPI slave
+    *
+    *  @returns
+    *    Response from the SPI slave
+    */
+    uint8_t SpiWrite(int value) {
+        // no MMPROFILE here : a probe per byte costs more than the frame, bursts are timed by make bench
+        uint8_t rxData = 0;
+        while( ( SPI1->SR & SPI_SR_TXE ) == 0 ){};
+        *( ( __IO uint8_t * ) &SPI1->DR ) = uint8_t ( value & 0xFF ); // 8 bits access : one frame
+        while( ( SPI1->SR & SPI_SR_RXNE ) == 0 ){};
+        rxData = *( ( __IO uint8_t * ) &SPI1->DR );
+        return (rxData);
+    };
+
+    /** Configure the data transmission format
+    *
+    *  @param bits Number of bits per SPI frame (4 - 16)
+    *  @param mode Clock polarity and phase mode (0 - 3)
+    *
+    * @code
+    * mode | POL PHA
+    * -----+--------
+    *   0  |  0   0
+    *   1  |  0   1
+    *   2  |  1   0
+    *   3  |  1   1
+    * @endcode
+    */
+    void Spiformat(int bits, int mode = 0) { } ;
+
+    /** Set the spi bus clock frequency
+    *
+    *  @param hz SCLK frequency in hz (default = 1MHz)
+    */
+    void SetSpiFrequency(int hz = 1000000) { } ;
+    PinName McuMosi;
+    PinName McuMiso;
+    PinName McuSclk;
+
+/******************************************************************************/
+/*                                Mcu Flash Api                               */
+/******************************************************************************/
+     /** RestoreContext data from a flash device.
+     *
+     *  This method invokes memcpy - reads number of bytes from the address
+     *
+     *  @param buffer Buffer to write to
+     *  @param addr   Flash address to begin reading from
+     *  @param size   Size to read in bytes
+     *  @return       0 on success, negative error code on failure
+     */
+    int RestoreContext(uint8_t *buffer, uint32_t addr, uint32_t size) {
+        memcpy ( buffer, ( const void * ) addr, size );
+        return ( 0 );
+    };
+
+/******************************************************************************/
+/*                                Mcu RTC Api                                 */
+/******************************************************************************/
+    /*!
+    * RtcGetTimeSecond : return the Current Rtc time in Second
+    * \remark is used for :
+    * \remark scheduling autonomous retransmissions (for exemple NbTrans) , transmitting MAC answers , basically any delay without accurate time constraints
+    * \remark also used to measure the time spent inside the LoRaWAN process for the integrated failsafe
+    * \param [IN]   void
+    * \param [OUT]  uint32_t RTC time in Second
+    */
+    uint32_t RtcGetTimeSecond       ( void ) {
+        RTC_TimeTypeDef timeStruct;
+        RTC_DateTypeDef dateStruct;
+        Family::RtcRead ( timeStruct, dateStruct );
+        return ( McuCoreEpochSecond ( dateStruct.Year, dateStruct.Month, dateStruct.Date, timeStruct.Hours, timeStruct.Minutes, timeStruct.Seconds ) );
+    };
+   /*!
+    * RtcGetTimeMs : return the Current Rtc time in Ms
+    * \remark is used to timestamp radio events (end of TX), will also be used for future classB
+    * \remark this function may be used by the application.
+    * \param [IN]   void
+    * \param [OUT]  uint32_t Current RTC time in ms wraps every 49 days
+    */
+    uint32_t RtcGetTimeMs  ( void ) {
+        MMPROFILE ( "RtcGetTimeMs" );
+        RTC_TimeTypeDef timeStruct;
+        RTC_DateTypeDef dateStruct;
+        Family::RtcRead ( timeStruct, dateStruct );
+        uint32_t t = McuCoreEpochSecond ( dateStruct.Year, dateStruct.Month, dateStruct.Date, timeStruct.Hours, timeStruct.Minutes, timeStruct.Seconds );
+        // the sub second register counts down from PREDIV_S
+        return ( ( t * 1000 ) + ( ( ( Family::RtcSubSecondMax - timeStruct.SubSeconds ) * 1000 ) / ( Family::RtcSubSecondMax + 1 ) ) );
+    };
+
+/******************************************************************************/
+/*                                Mcu Sleep Api                               */
+/******************************************************************************/
+    /*!
+    * GotoSleepSecond : sleep for duration seconds, by chunks of WATCH_DOG_PERIOD_RELEASE seconds
+    * \remark the watchdog is released after each chunk, the sleep can be longer than the IWDG period
+    * \remark the timeout of the tasks checked in from thread mode is suspended meanwhile, see McuWatchDogSleep
+    * \param [IN]   int duration in seconds
+    * \param [OUT]  void
+    */
+    void GotoSleepSecond ( int duration ) {
+        int cpt = duration;
+        McuWatchDogSleep ( 1 );
+        McuWatchDogRelease ( );
+        while ( cpt > WATCH_DOG_PERIOD_RELEASE ) {
+            cpt -= WATCH_DOG_PERIOD_RELEASE;
+            static_cast < Family * > ( this )->SleepSecond ( WATCH_DOG_PERIOD_RELEASE );
+            McuWatchDogRelease ( );
+        }
+        static_cast < Family * > ( this )->SleepSecond ( cpt );
+        McuWatchDogRelease ( );
+        McuWatchDogSleep ( 0 );
+    };
+
+/******************************************************************************/
+/*                             Mcu WatchDog Api                               */
+/******************************************************************************/
+    /* A function to init and start the Watchdog
+    * \remark The expired period is longer than WATCH_DOG_PERIOD_RELEASE seconds, see McuWatchDog.h
+    * \param [IN]   void
+    * \param [OUT]  void
+    */
+    void WatchDogStart ( void ) { McuWatchDogStart ( ); };
+
+    /* A function to release the Watchdog
+    * \remark Application have to call this function periodically (with a period <WATCH_DOG_PERIOD_RELEASE)
+    *         If not , the mcu will reset.
+    * \remark The Watchdog is not released if one of the registered tasks missed its check in
+    * \param [IN]   void
+    * \param [OUT]  void
+    */
+    void WatchDogRelease ( void ) { McuWatchDogRelease ( ); };
+
+    /* A function to add a task supervised by the Watchdog
+    * \remark The task have to call WatchDogCheckIn at least every timeoutSecond seconds
+    * \param [IN]   const char * name, not copied
+    * \param [IN]   uint32_t timeoutSecond
+    * \param [OUT]  int task id, -1 if the table is full
+    */
+    int  WatchDogRegister ( const char * name, uint32_t timeoutSecond ) { return ( McuWatchDogRegister ( name, timeoutSecond ) ); };
+
+    /* A function to tell the Watchdog that a registered task is alive
+    * \remark Can be called from an ISR
+    * \param [IN]   int task id returned by WatchDogRegister
+    * \param [OUT]  void
+    */
+    void WatchDogCheckIn ( int id ) { McuWatchDogCheckIn ( id ); };
+
+/******************************************************************************/
+/*                      Mcu Low Power Timer Api                               */
+/******************************************************************************/
+/*!
+    * LowPowerTimerLoRa Init
+    *\remark initializes the dedicated LoRaWAN low power timer object. MCU specific.
+    * \param [IN]  void
+    * \param [OUT] void
+    */
+    void LowPowerTimerLoRaInit ( void ) {
+        Family::LptimInit ( );
+        Func = DoNothing;
+        obj = NULL;
+    };
+    /*!
+    * LowPowerTimerLoRa AttachMsecond
+    *
+    * \param void (* _Func) (void *) a static method member of the current Obj
+    * \param *_obj a pointer to the current objet
+    * \param int delay in ms delay should be between 1ms and 16s.
+    * \param [OUT] void
+    * \remark starts the LoRaWAN dedicated timer and attaches the IRQ to the handling Interupt Service Routine in the LoRaWAN object.
+    */
+    void StartTimerMsecond     ( void (* _Func) (void *) , void * _obj, int delay) {
+        Func =  _Func ;
+        obj  = _obj;
+        // LSE / 16 : 2.048 ticks per ms
+        Family::LptimStart ( delay * 2 + ( ( 6 * delay ) >> 7 ) );
+    };
+
+    /*!
+    *  timerISR
+    * \remark    Do Not Modify
+    * \remark    with EVENT_LOOP_ENABLE the callback runs later from McuEventDispatch
+    * \remark    in SRAM2 with the LPTIM1 handler, see McuSections.h
+    */
+    MCU_RAMFUNC void timerISR  ( void ) {
+#if EVENT_LOOP_ENABLE == 1
+        McuEventPost ( EVENT_QUEUE_TIMER, Func, obj );
+#else
+        Func(obj);
+#endif
+    };
+    /*!
+    * TimerCallback : callback armed by StartTimerMsecond, DoNothing when no timer is pending
+    * \remark used by the crash dump to tell which timer was running
+    */
+    void * TimerCallback       ( void ) { return ( ( void * ) Func ); };
+
+/******************************************************************************/
+/*                           Mcu Gpio Api                                     */
+/******************************************************************************/
+    /*!
+    * SetValueDigitalOutPin / GetValueDigitalInPin
+    * \remark a PinName is port * 16 + line : the port registers are found with the NC test only
+    * \remark BSRR is written in one access, safe against an ISR driving another line of the port
+    * \remark an NC pin (Board::Busy of the sx1276 board) is ignored and read as 0
+    */
+    void SetValueDigitalOutPin ( PinName Pin, int Value ) {
+        if ( Pin == NC ) {
+            return;
+        }
+        uint32_t bit = 1U << ( Pin & 0xF );
+        GpioPort ( Pin )->BSRR = ( Value != 0 ) ? bit : ( bit << 16 );
+    };
+    int  GetValueDigitalInPin  ( PinName Pin ) {
+        if ( Pin == NC ) {
+            return ( 0 );
+        }
+        return ( ( GpioPort ( Pin )->IDR >> ( Pin & 0xF ) ) & 1 );
+    };
+    void AttachInterruptIn     (  void (* _Funcext) (void *) , void * _objext) {
+        Funcext =  _Funcext ;
+        objext  = _objext;
+        userIt  = 0 ;
+    };
+    void AttachInterruptIn     (  void (* _Funcext) ( void ) ) { _UserFuncext = _Funcext; userIt = 1 ; };
+    void DetachInterruptIn     (  void (* _Funcext) ( void ) ) { userIt = 0 ; };
+    /*!
+    *  ExtISR
+    * \remark    Do Not Modify
+    * \remark    with EVENT_LOOP_ENABLE the callback runs later from McuEventDispatch
+    * \remark    in SRAM2 with the EXTI handlers, see McuSections.h
+    */
+    MCU_RAMFUNC void ExtISR    ( void ) {
+#if EVENT_LOOP_ENABLE == 1
+        if (userIt == 0 ) {
+        McuEventPost ( EVENT_QUEUE_RADIO, Funcext, objext );
+        } else {
+        McuEventPostVoid ( EVENT_QUEUE_RADIO, _UserFuncext );
+        };
+#else
+        if (userIt == 0 ) {
+        Funcext(objext);
+        } else {
+        _UserFuncext ();
+        };
+#endif
+    };
+
+/*****************************************************************************/
+/*                                    Get Unique Id                          */
+/*****************************************************************************/
+    void GetUniqueId ( uint8_t  DevEui[8] ) {
+        const char* UID = (char*)Family::UidAddress;
+        uint32_t uid;
+        memcpy(&uid, UID, 4);
+        DevEui[7] =(uint8_t)(uid&0xff);
+        DevEui[6] =(uint8_t)((uid>>8)&0xFF);
+        DevEui[5] =(uint8_t)((uid>>16)&0xFF);
+        DevEui[4] =(uint8_t)((uid>>24)&0xFF);
+        memcpy(&uid, UID + 4, 4);
+        DevEui[3] =(uint8_t)(uid&0xFF);
+        DevEui[2] =(uint8_t)((uid>>8)&0xFF);
+        DevEui[1] =(uint8_t)((uid>>16)&0xFF);
+        DevEui[0] =(uint8_t)((uid>>24)&0xFF);
+    }
+protected :
+    // not for NC : its port would be the reserved area after GPIOH
+    static GPIO_TypeDef * GpioPort ( PinName Pin ) {
+        return ( ( GPIO_TypeDef * ) ( GPIOA_BASE + ( ( Pin >> 4 ) & 0xF ) * ( GPIOB_BASE - GPIOA_BASE ) ) );
+    };
+    /*!
+    *  Low power timer
+    * \remark    Do Not Modify
+    */
+    static void DoNothing (void *) { };
+    void (* Func) (void *);
+    void * obj;
+    void (* Funcext) (void *);
+    void * objext;
+    void (* _UserFuncext) ( void );
+    int userIt;
+};
+
+#endif
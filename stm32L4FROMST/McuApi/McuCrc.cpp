@@ -0,0 +1,29 @@
+/*
+ __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Integrity checks.
+
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#include "McuCrc.h"
+
+uint32_t McuCrc32 ( const void * data, uint32_t length ) {
+    const uint8_t * bytes = ( const uint8_t * ) data;
+    uint32_t        crc = 0xFFFFFFFF;
+    for ( uint32_t i = 0; i < length; i++ ) {
+        crc ^= bytes [ i ];
+        for ( int bit = 0; bit < 8; bit++ ) {
+            crc = ( crc >> 1 ) ^ ( 0xEDB88320 & ( 0 - ( crc & 1 ) ) );
+        }
+    }
+    return ( ~crc );
+}
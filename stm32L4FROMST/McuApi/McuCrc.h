@@ -0,0 +1,27 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Integrity checks of the data kept across resets (crash dump, flash context).
+
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_CRC_H
+#define MCU_CRC_H
+#include "stdint.h"
+
+/*!
+ * McuCrc32 : crc32 (ieee 802.3, reflected) of a buffer
+ */
+uint32_t McuCrc32 ( const void * data, uint32_t length );
+
+#endif
@@ -0,0 +1,78 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Short critical sections for data shared between the Mcu layer ISRs and the main loop.
+
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_CRITICAL_H
+#define MCU_CRITICAL_H
+#if defined ( MCU_POSIX )
+    #include "ClassPosix.h"
+#else
+    #include "McuHal.h"
+    #if !defined ( MCU_STM32L0 )
+        #include "McuPriority.h"
+    #endif
+#endif
+
+/*!
+ * McuEnterCritical / McuExitCritical
+ * \remark BASEPRI is raised to NVIC_PRIORITY_CRITICAL (McuPriority.h) : the Mcu layer ISRs are held off,
+ *         the watchdog and the faults are not
+ * \remark BASEPRI is saved and restored so the pair can be nested and used from an ISR
+ * \remark keep the protected section a few instructions long, the radio and timer ISRs are held off
+ * \remark on the host the interrupt thread is held off by a recursive lock
+ * \remark the Cortex-M0+ of the STM32L0 has no BASEPRI : PRIMASK holds off every interrupt
+ */
+#if defined ( MCU_POSIX )
+static inline uint32_t McuEnterCritical ( void ) {
+    McuPosixIrqLock ( );
+    return ( 0 );
+}
+
+static inline void McuExitCritical ( uint32_t primask ) {
+    McuPosixIrqUnlock ( );
+}
+#elif defined ( MCU_STM32L0 )
+static inline uint32_t McuEnterCritical ( void ) {
+    uint32_t primask = __get_PRIMASK ( );
+    __disable_irq ( );
+    return ( primask );
+}
+
+static inline void McuExitCritical ( uint32_t primask ) {
+    __set_PRIMASK ( primask );
+}
+#else
+static inline uint32_t McuEnterCritical ( void ) {
+    uint32_t basepri = __get_BASEPRI ( );
+    // only raises the mask : a section nested in a higher priority one keeps the higher mask
+    __set_BASEPRI_MAX ( NVIC_PRIORITY_CRITICAL << ( 8U - __NVIC_PRIO_BITS ) );
+    return ( basepri );
+}
+
+static inline void McuExitCritical ( uint32_t basepri ) {
+    __set_BASEPRI ( basepri );
+}
+#endif
+
+class McuCriticalSection {
+public :
+    McuCriticalSection  ( ) { State = McuEnterCritical ( ); };
+    ~McuCriticalSection ( ) { McuExitCritical ( State ); };
+private :
+    uint32_t State;
+};
+
+#endif
@@ -0,0 +1,151 @@
+/*
+ __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Energy accounting.
+
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#include "McuEnergy.h"
+#include "ApiMcu.h"
+#include "McuCritical.h"
+#include "McuProfile.h"
+#include "stm32l4xx_hal.h"
+
+static const uint32_t EnergyCurrentUa [ ENERGY_STATE_NUMBER ] = {
+    ENERGY_UA_RUN_RANGE1, ENERGY_UA_RUN_RANGE2, ENERGY_UA_SLEEP, ENERGY_UA_STOP1, ENERGY_UA_STOP2,
+    ENERGY_UA_RADIO_TX, ENERGY_UA_RADIO_RX, ENERGY_UA_FLASH_ERASE, ENERGY_UA_FLASH_PROGRAM
+};
+static const char * const EnergyNames [ ENERGY_STATE_NUMBER ] = {
+    "run r1", "run r2", "sleep", "stop1", "stop2", "radio tx", "radio rx", "erase", "program"
+};
+
+static uint64_t EnergyUs [ ENERGY_STATE_NUMBER ];
+static uint32_t EnergyLastCycles = 0;
+static uint32_t EnergyConsumers = 0;   // bit per active consumer state
+static uint8_t  EnergyMode = ENERGY_RUN_RANGE1;
+static uint32_t EnergyLowPowerStartMs = 0;
+static int      EnergyStarted = 0;
+
+static void EnergyAccount ( uint64_t us ) {
+    EnergyUs [ EnergyMode ] += us;
+    for ( int state = ENERGY_FIRST_CONSUMER; state < ENERGY_STATE_NUMBER; state++ ) {
+        if ( ( EnergyConsumers & ( 1U << state ) ) != 0 ) {
+            EnergyUs [ state ] += us;
+        }
+    }
+}
+
+/* run time since the last call, the sub-microsecond remainder is kept for the next one */
+static void EnergyAccountRun ( void ) {
+    uint32_t perUs = SystemCoreClock / 1000000;
+    uint32_t cycles = McuProfileNow ( ) - EnergyLastCycles;
+    uint32_t us = cycles / perUs;
+    EnergyLastCycles += us * perUs;
+    EnergyAccount ( us );
+}
+
+void McuEnergyInit ( void ) {
+    McuProfileInit ( );
+    EnergyMode = ( HAL_PWREx_GetVoltageRange ( ) == PWR_REGULATOR_VOLTAGE_SCALE1 ) ? ENERGY_RUN_RANGE1 : ENERGY_RUN_RANGE2;
+    EnergyLastCycles = McuProfileNow ( );
+    EnergyStarted = 1;
+}
+
+void McuEnergyUpdate ( void ) {
+    if ( EnergyStarted == 0 ) {
+        return;
+    }
+    uint32_t primask = McuEnterCritical ( );
+    EnergyAccountRun ( );
+    // the voltage range may have been changed with the clocks : the new run mode counts from now
+    EnergyMode = ( HAL_PWREx_GetVoltageRange ( ) == PWR_REGULATOR_VOLTAGE_SCALE1 ) ? ENERGY_RUN_RANGE1 : ENERGY_RUN_RANGE2;
+    McuExitCritical ( primask );
+}
+
+void McuEnergyLowPowerEnter ( uint8_t mode ) {
+    if ( EnergyStarted == 0 ) {
+        return;
+    }
+    McuEnergyUpdate ( );
+    EnergyLowPowerStartMs = mcu.RtcGetTimeMs ( );
+    EnergyMode = mode;
+}
+
+void McuEnergyLowPowerExit ( void ) {
+    if ( EnergyStarted == 0 ) {
+        return;
+    }
+    uint32_t primask = McuEnterCritical ( );
+    EnergyAccount ( ( uint64_t ) ( mcu.RtcGetTimeMs ( ) - EnergyLowPowerStartMs ) * 1000 );
+    EnergyMode = ( HAL_PWREx_GetVoltageRange ( ) == PWR_REGULATOR_VOLTAGE_SCALE1 ) ? ENERGY_RUN_RANGE1 : ENERGY_RUN_RANGE2;
+    EnergyLastCycles = McuProfileNow ( ); // the cycle counter did not count the low power period
+    McuExitCritical ( primask );
+}
+
+void McuEnergySleepEnter ( void ) {
+    if ( EnergyStarted == 0 ) {
+        return;
+    }
+    EnergyAccountRun ( );
+    EnergyMode = ENERGY_SLEEP;
+}
+
+void McuEnergySleepExit ( void ) {
+    if ( EnergyStarted == 0 ) {
+        return;
+    }
+    EnergyAccountRun ( ); // the cycles since McuEnergySleepEnter, in ENERGY_SLEEP
+    EnergyMode = ( HAL_PWREx_GetVoltageRange ( ) == PWR_REGULATOR_VOLTAGE_SCALE1 ) ? ENERGY_RUN_RANGE1 : ENERGY_RUN_RANGE2;
+}
+
+void McuEnergyConsumer ( uint8_t state, int on ) {
+    if ( ( EnergyStarted == 0 ) || ( state < ENERGY_FIRST_CONSUMER ) || ( state >= ENERGY_STATE_NUMBER ) ) {
+        return;
+    }
+    uint32_t primask = McuEnterCritical ( );
+    if ( EnergyMode <= ENERGY_RUN_RANGE2 ) {
+        EnergyAccountRun ( );
+    }
+    if ( on != 0 ) {
+        EnergyConsumers |= ( 1U << state );
+    } else {
+        EnergyConsumers &= ~( 1U << state );
+    }
+    McuExitCritical ( primask );
+}
+
+uint32_t McuEnergyResidencyMs ( uint8_t state ) {
+    return ( ( state < ENERGY_STATE_NUMBER ) ? ( uint32_t ) ( EnergyUs [ state ] / 1000 ) : 0 );
+}
+
+static uint64_t EnergyStateNah ( int state ) {
+    // uA x us = 1e-12 C, 1 nAh = 3.6e-6 C
+    return ( ( EnergyUs [ state ] * EnergyCurrentUa [ state ] ) / 3600000 );
+}
+
+uint64_t McuEnergyChargeNah ( void ) {
+    uint64_t charge = 0;
+    for ( int state = 0; state < ENERGY_STATE_NUMBER; state++ ) {
+        charge += EnergyStateNah ( state );
+    }
+    return ( charge );
+}
+
+void McuEnergyPrint ( void ) {
+    McuEnergyUpdate ( );
+    for ( int state = 0; state < ENERGY_STATE_NUMBER; state++ ) {
+        mcu.MMprint ( "%-8s %10lu ms %6lu uA %10lu nAh\n", EnergyNames [ state ], ( unsigned long ) McuEnergyResidencyMs ( state ),
+                      ( unsigned long ) EnergyCurrentUa [ state ], ( unsigned long ) EnergyStateNah ( state ) );
+    }
+    uint64_t charge = McuEnergyChargeNah ( );
+    mcu.MMprint ( "total %lu.%03lu uAh\n", ( unsigned long ) ( charge / 1000 ), ( unsigned long ) ( charge % 1000 ) );
+}
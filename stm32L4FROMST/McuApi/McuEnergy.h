@@ -0,0 +1,123 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Energy accounting.
+                    The mcu is always in one mode (run range 1 or 2, sleep, stop1, stop2), the radio and
+                    the flash are consumers added on top of it while they are active. The time spent in
+                    each state is counted with the DWT cycle counter while the core runs and with the RTC
+                    across the low power modes. Multiplied by the ENERGY_UA_xxx current table it gives an
+                    estimate of the charge drawn from the battery since the reset.
+                    The cycle counter wraps every 67 s at 64 MHz : McuEnergyUpdate has to be called more
+                    often than that, the main loop does it.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_ENERGY_H
+#define MCU_ENERGY_H
+#include "stdint.h"
+#include "UserDefine.h"
+
+/* Current table in uA, override them in UserDefine.h with the board measurements */
+#ifndef ENERGY_UA_RUN_RANGE1
+    #define ENERGY_UA_RUN_RANGE1   7000  // 64 MHz from flash, 110 uA/MHz
+#endif
+#ifndef ENERGY_UA_RUN_RANGE2
+    #define ENERGY_UA_RUN_RANGE2   2400  // up to 26 MHz, 95 uA/MHz
+#endif
+#ifndef ENERGY_UA_SLEEP
+    #define ENERGY_UA_SLEEP        1800
+#endif
+#ifndef ENERGY_UA_STOP1
+    #define ENERGY_UA_STOP1        7
+#endif
+#ifndef ENERGY_UA_STOP2
+    #define ENERGY_UA_STOP2        2
+#endif
+#ifndef ENERGY_UA_RADIO_TX
+    #define ENERGY_UA_RADIO_TX     28000 // sx1276 at +14 dBm
+#endif
+#ifndef ENERGY_UA_RADIO_RX
+    #define ENERGY_UA_RADIO_RX     11500
+#endif
+#ifndef ENERGY_UA_FLASH_ERASE
+    #define ENERGY_UA_FLASH_ERASE  3400  // on top of the run current
+#endif
+#ifndef ENERGY_UA_FLASH_PROGRAM
+    #define ENERGY_UA_FLASH_PROGRAM 3400
+#endif
+
+enum {
+    /* mcu modes, exclusive */
+    ENERGY_RUN_RANGE1 = 0,
+    ENERGY_RUN_RANGE2,
+    ENERGY_SLEEP,
+    ENERGY_STOP1,
+    ENERGY_STOP2,
+    /* consumers, added to the mcu mode */
+    ENERGY_RADIO_TX,
+    ENERGY_RADIO_RX,
+    ENERGY_FLASH_ERASE,
+    ENERGY_FLASH_PROGRAM,
+    ENERGY_STATE_NUMBER
+};
+#define ENERGY_FIRST_CONSUMER ENERGY_RADIO_TX
+
+/*!
+ * McuEnergyInit : start counting in run mode, needs the cycle counter and the RTC
+ */
+void     McuEnergyInit          ( void );
+
+/*!
+ * McuEnergyUpdate : account the run time elapsed since the last call
+ * \remark thread context only, at least every 60 seconds
+ */
+void     McuEnergyUpdate        ( void );
+
+/*!
+ * McuEnergyLowPowerEnter / McuEnergyLowPowerExit : bracket a Sleep or Stop period
+ * \param [IN]  uint8_t mode ENERGY_SLEEP, ENERGY_STOP1 or ENERGY_STOP2
+ */
+void     McuEnergyLowPowerEnter ( uint8_t mode );
+void     McuEnergyLowPowerExit  ( void );
+
+/*!
+ * McuEnergySleepEnter / McuEnergySleepExit : bracket a WFI of the main loop idle
+ * \remark the Sleep time is counted with the cycle counter, which keeps running while only the core clock is
+ *         gated : two counter reads instead of the RTC reads of McuEnergyLowPowerEnter, cheap enough for a
+ *         sleep ended by each SysTick
+ * \remark interrupts disabled, thread context
+ */
+void     McuEnergySleepEnter    ( void );
+void     McuEnergySleepExit     ( void );
+
+/*!
+ * McuEnergyConsumer : a consumer starts (on = 1) or stops (on = 0) drawing current
+ * \remark reported by the radio driver for ENERGY_RADIO_TX / RX, by the flash api for the flash states
+ */
+void     McuEnergyConsumer      ( uint8_t state, int on );
+
+/*!
+ * McuEnergyResidencyMs : time spent in a state since the reset, in ms
+ */
+uint32_t McuEnergyResidencyMs   ( uint8_t state );
+
+/*!
+ * McuEnergyChargeNah : estimated charge drawn since the reset, in nAh
+ */
+uint64_t McuEnergyChargeNah     ( void );
+
+/*!
+ * McuEnergyPrint : print the residency and the charge of each state
+ */
+void     McuEnergyPrint         ( void );
+
+#endif
@@ -0,0 +1,133 @@
+/*
+ __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Event queues from the interrupts to the main loop.
+
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#include "McuEvent.h"
+#include "ApiMcu.h"
+#include "McuSections.h"
+#if defined ( MCU_POSIX )
+    #include "ClassPosix.h"
+#else
+    #include "McuHal.h"
+    #if MCU_HAS_DWT == 1
+        #include "McuEnergy.h"
+    #endif
+#endif
+
+#if ( EVENT_QUEUE_SIZE & ( EVENT_QUEUE_SIZE - 1 ) ) != 0
+    #error "EVENT_QUEUE_SIZE have to be a power of 2"
+#endif
+
+typedef struct {
+    McuEventHandler Handler;
+    void *          Context;
+} McuEvent_t;
+
+/* Head and Tail are free running counters : Head counts the posts, Tail the dispatches */
+typedef struct {
+    McuEvent_t Events [ EVENT_QUEUE_SIZE ];
+    uint32_t   Head;      // written by the producer only
+    uint32_t   Tail;      // written by the main loop only
+    uint32_t   Peak;      // producer
+    uint32_t   Dropped;   // producer
+} McuEventQueue_t;
+
+static McuEventQueue_t EventQueues [ EVENT_QUEUE_NUMBER ];
+static const char * const EventQueueNames [ EVENT_QUEUE_NUMBER ] = { "timer", "radio", "main" };
+
+static void EventCallVoid ( void * handler ) {
+    ( ( void ( * ) ( void ) ) handler ) ( );
+}
+
+MCU_RAMFUNC int McuEventPost ( uint8_t queueId, McuEventHandler handler, void * context ) {
+    McuEventQueue_t * queue = &EventQueues [ queueId ];
+    uint32_t head = queue->Head;
+    uint32_t used = head - __atomic_load_n ( &queue->Tail, __ATOMIC_ACQUIRE );
+    if ( used >= EVENT_QUEUE_SIZE ) {
+        queue->Dropped++;
+        return ( -1 );
+    }
+    queue->Events [ head & ( EVENT_QUEUE_SIZE - 1 ) ].Handler = handler;
+    queue->Events [ head & ( EVENT_QUEUE_SIZE - 1 ) ].Context = context;
+    // the event is written before the main loop can see the new head
+    __atomic_store_n ( &queue->Head, head + 1, __ATOMIC_RELEASE );
+    if ( used + 1 > queue->Peak ) {
+        queue->Peak = used + 1;
+    }
+    return ( 0 );
+}
+
+MCU_RAMFUNC int McuEventPostVoid ( uint8_t queueId, void ( * handler ) ( void ) ) {
+    return ( McuEventPost ( queueId, EventCallVoid, ( void * ) handler ) );
+}
+
+int McuEventDispatch ( void ) {
+    int run = 0;
+    for ( int q = 0; q < EVENT_QUEUE_NUMBER; q++ ) {
+        McuEventQueue_t * queue = &EventQueues [ q ];
+        uint32_t tail = queue->Tail;
+        uint32_t head = __atomic_load_n ( &queue->Head, __ATOMIC_ACQUIRE ); // later posts wait for the next call
+        while ( tail != head ) {
+            McuEvent_t event = queue->Events [ tail & ( EVENT_QUEUE_SIZE - 1 ) ];
+            tail++;
+            // the slot is read before the producer can reuse it
+            __atomic_store_n ( &queue->Tail, tail, __ATOMIC_RELEASE );
+            event.Handler ( event.Context );
+            run++;
+        }
+    }
+    return ( run );
+}
+
+int McuEventPending ( void ) {
+    for ( int q = 0; q < EVENT_QUEUE_NUMBER; q++ ) {
+        if ( __atomic_load_n ( &EventQueues [ q ].Head, __ATOMIC_ACQUIRE ) != EventQueues [ q ].Tail ) {
+            return ( 1 );
+        }
+    }
+    return ( 0 );
+}
+
+void McuEventIdle ( void ) {
+#if defined ( MCU_POSIX )
+    if ( McuEventPending ( ) == 0 ) {
+        McuPosixIdle ( POSIX_IDLE_MAX_US );
+    }
+#else
+    // PRIMASK and not McuEnterCritical : a pending interrupt masked by BASEPRI would not end the WFI
+    __disable_irq ( );
+    // the SysTick ends the sleep every ms : McuEnergyLowPowerEnter, which reads the RTC, would cost more
+    if ( McuEventPending ( ) == 0 ) {
+#if MCU_HAS_DWT == 1
+        McuEnergySleepEnter ( );
+#endif
+        __DSB ( );
+        __WFI ( );
+#if MCU_HAS_DWT == 1
+        McuEnergySleepExit ( );
+#endif
+    }
+    __enable_irq ( );
+#endif
+}
+
+void McuEventPrint ( void ) {
+    for ( int q = 0; q < EVENT_QUEUE_NUMBER; q++ ) {
+        McuEventQueue_t * queue = &EventQueues [ q ];
+        mcu.MMprint ( "event queue %-5s : %lu posted, %lu dispatched, peak %lu/%d, %lu dropped\n", EventQueueNames [ q ],
+                      ( unsigned long ) queue->Head, ( unsigned long ) queue->Tail, ( unsigned long ) queue->Peak,
+                      EVENT_QUEUE_SIZE, ( unsigned long ) queue->Dropped );
+    }
+}
@@ -0,0 +1,84 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Event queues from the interrupts to the main loop.
+                    With EVENT_LOOP_ENABLE = 1 (UserDefine.h) timerISR and ExtISR only post the callback
+                    armed by StartTimerMsecond or AttachInterruptIn : the LoRaWAN and radio processing
+                    runs at thread level from McuEventDispatch, the interrupts stay a few instructions long.
+                    Each queue has one producer and one consumer, the main loop : a post and a dispatch
+                    are lock free. A queue is fed by one interrupt or by interrupts that cannot preempt
+                    each other (same NVIC priority, McuPriority.h), EVENT_QUEUE_MAIN by the main loop itself.
+                    The main loop :
+                        while ( 1 ) {
+                            ...
+                            if ( McuEventDispatch ( ) == 0 ) {
+                                McuEventIdle ( );
+                            }
+                        }
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_EVENT_H
+#define MCU_EVENT_H
+#include "stdint.h"
+#include "UserDefine.h"
+
+#ifndef EVENT_QUEUE_SIZE
+    #define EVENT_QUEUE_SIZE 8 // events per queue, have to be a power of 2
+#endif
+
+enum {
+    EVENT_QUEUE_TIMER = 0,  // LPTIM1, timerISR
+    EVENT_QUEUE_RADIO,      // EXTI, ExtISR
+    EVENT_QUEUE_MAIN,       // work deferred by the main loop
+    EVENT_QUEUE_NUMBER
+};
+
+typedef void ( * McuEventHandler ) ( void * context );
+
+/*!
+ * McuEventPost : queue handler ( context ) for the main loop
+ * \remark lock free, one producer per queue : an ISR or the main loop for EVENT_QUEUE_MAIN
+ * \param [IN]  queue    EVENT_QUEUE_xxx
+ * \param [OUT] return   0, -1 if the queue is full : the event is dropped and counted
+ */
+int  McuEventPost     ( uint8_t queue, McuEventHandler handler, void * context );
+
+/*!
+ * McuEventPostVoid : same for a handler without argument
+ */
+int  McuEventPostVoid ( uint8_t queue, void ( * handler ) ( void ) );
+
+/*!
+ * McuEventDispatch : run the events queued before the call, in the post order of each queue
+ * \remark main loop only, the events posted by the handlers run at the next call
+ * \param [OUT] return   number of events run
+ */
+int  McuEventDispatch ( void );
+
+/*!
+ * McuEventPending : 1 if an event is waiting in a queue
+ */
+int  McuEventPending  ( void );
+
+/*!
+ * McuEventIdle : sleep (WFI) until the next interrupt unless an event is pending
+ * \remark the check and the WFI run with PRIMASK set : a post just before the sleep wakes it up at once
+ */
+void McuEventIdle     ( void );
+
+/*!
+ * McuEventPrint : print the posted, dispatched, peak and dropped counts of the queues
+ */
+void McuEventPrint    ( void );
+
+#endif
@@ -0,0 +1,225 @@
+/*
+ __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Crash dump.
+
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#include "McuFault.h"
+#include "ApiMcu.h"
+#include "McuLog.h"
+#include "McuTrace.h"
+#include "McuCrc.h"
+#include "McuSections.h"
+#include "stm32l4xx_hal.h"
+#include "usart.h"
+#include "stm32l4xx_it.h"
+#include "wwdg.h"
+#include "stddef.h"
+
+#define FAULT_HANDLER_STACK_BYTES 512 // a plain number : McuFaultEntry pastes it in its asm
+#define FAULT_HANDLER_STACK_WORDS ( FAULT_HANDLER_STACK_BYTES / 4 )
+#define FAULT_STRING2( x )        #x
+#define FAULT_STRING( x )         FAULT_STRING2 ( x )
+static_assert ( ( FAULT_HANDLER_STACK_BYTES % 8 ) == 0, "the fault handler stack top has to be 8 bytes aligned" );
+
+MCU_SRAM2_NOINIT static McuFaultRecord_t FaultRecord;
+
+/* The handler runs on its own stack : the faulting one may be corrupted or overflowed */
+extern "C" {
+    uint32_t McuFaultStack [ FAULT_HANDLER_STACK_WORDS ] __attribute__ ( ( used, aligned ( 8 ) ) ); // only named in the asm of McuFaultEntry
+    void     McuFaultRecord ( uint32_t * frame, uint32_t excReturn, uint32_t * calleeSaved ) __attribute__ ( ( used, noreturn ) );
+    void     McuFaultEntry  ( void ) __attribute__ ( ( naked ) );
+}
+
+static const char * const FaultNames [ ] = { "HardFault", "MemManage", "BusFault", "UsageFault" };
+
+static const char * FaultName ( uint32_t exception ) {
+    if ( ( exception >= 3 ) && ( exception <= 6 ) ) {
+        return ( FaultNames [ exception - 3 ] );
+    }
+    return ( ( exception == ( uint32_t ) WWDG_IRQn + 16 ) ? "WWDG early wakeup" : "fault" );
+}
+
+static const char * const CfsrNames [ 32 ] = {
+    "IACCVIOL", "DACCVIOL", 0, "MUNSTKERR", "MSTKERR", "MLSPERR", 0, "MMARVALID",
+    "IBUSERR", "PRECISERR", "IMPRECISERR", "UNSTKERR", "STKERR", "LSPERR", 0, "BFARVALID",
+    "UNDEFINSTR", "INVSTATE", "INVPC", "NOCP", 0, 0, 0, 0,
+    "UNALIGNED", "DIVBYZERO", 0, 0, 0, 0, 0, 0
+};
+
+/********************************************************************/
+/*                         Fault handler                            */
+/********************************************************************/
+static int FaultReadable ( uint32_t address, uint32_t length ) {
+    return ( ( ( address >= SRAM1_BASE ) && ( address + length <= SRAM1_BASE + SRAM1_SIZE_MAX + SRAM2_SIZE ) ) // SRAM2 is also mapped after SRAM1
+          || ( ( address >= SRAM2_BASE ) && ( address + length <= SRAM2_BASE + SRAM2_SIZE ) ) );
+}
+
+static uint32_t FaultRecordCrc ( const McuFaultRecord_t * record ) {
+    return ( McuCrc32 ( &record->Exception, offsetof ( McuFaultRecord_t, Crc ) - offsetof ( McuFaultRecord_t, Exception ) ) );
+}
+
+void McuFaultEntry ( void ) {
+    __asm volatile (
+        "tst    lr, #4                      \n" // EXC_RETURN bit 2 : the frame is on the process stack
+        "ite    eq                          \n"
+        "mrseq  r0, msp                     \n"
+        "mrsne  r0, psp                     \n"
+        "mov    r1, lr                      \n"
+        "ldr    r2, =McuFaultStack + " FAULT_STRING ( FAULT_HANDLER_STACK_BYTES ) "\n" // top of McuFaultStack
+        "mov    sp, r2                      \n"
+        "push   {r4-r11}                    \n"
+        "mov    r2, sp                      \n"
+        "b      McuFaultRecord              \n"
+    );
+}
+
+#if FAULT_DUMP_ENABLE == 1
+void HardFault_Handler  ( void ) __attribute__ ( ( alias ( "McuFaultEntry" ) ) );
+void MemManage_Handler  ( void ) __attribute__ ( ( alias ( "McuFaultEntry" ) ) );
+void BusFault_Handler   ( void ) __attribute__ ( ( alias ( "McuFaultEntry" ) ) );
+void UsageFault_Handler ( void ) __attribute__ ( ( alias ( "McuFaultEntry" ) ) );
+#endif
+#if WWDG_ENABLE == 1
+void WWDG_IRQHandler    ( void ) __attribute__ ( ( alias ( "McuFaultEntry" ) ) );
+#endif
+
+void McuFaultRecord ( uint32_t * frame, uint32_t excReturn, uint32_t * calleeSaved ) {
+    McuFaultRecord_t * record = &FaultRecord;
+    uint32_t *         stacked = &record->R0;
+    uint32_t           sp = ( uint32_t ) ( uintptr_t ) frame;
+    uint32_t           exception = __get_IPSR ( ) & 0x1FF;
+
+    if ( exception == ( uint32_t ) WWDG_IRQn + 16 ) {
+        WWDG->CR = WWDG_CR_T; // the reset comes one WWDG tick after the early wakeup : buy time to save the dump
+    }
+    record->Magic     = 0;
+    record->Exception = exception;
+    record->Tick      = HAL_GetTick ( );
+    record->ExcReturn = excReturn;
+    for ( int i = 0; i < 8; i++ ) {
+        stacked [ i ]        = FaultReadable ( sp, 32 ) ? frame [ i ] : 0;
+        record->R4_R11 [ i ] = calleeSaved [ i ];
+    }
+    // rewind the exception entry : 8 words, 26 with the fpu context, plus the alignment word
+    sp += ( ( excReturn & 0x10 ) == 0 ) ? 26 * 4 : 8 * 4;
+    if ( ( record->Psr & ( 1U << 9 ) ) != 0 ) {
+        sp += 4;
+    }
+    record->Sp    = sp;
+    record->Cfsr  = SCB->CFSR;
+    record->Hfsr  = SCB->HFSR;
+    record->Mmfar = SCB->MMFAR;
+    record->Bfar  = SCB->BFAR;
+    record->TimerCallback = ( uint32_t ) ( uintptr_t ) mcu.TimerCallback ( );
+    record->TraceIdNumber = McuTraceLastIds ( record->TraceIds, TRACE_LAST_IDS );
+    record->StackWords = 0;
+    while ( ( record->StackWords < FAULT_STACK_WORDS ) && FaultReadable ( sp, 4 ) ) {
+        record->Stack [ record->StackWords++ ] = *( uint32_t * ) ( uintptr_t ) sp;
+        sp += 4;
+    }
+    record->TraceBytes = McuTraceSnapshot ( record->Trace, FAULT_TRACE_BYTES );
+    record->Crc   = FaultRecordCrc ( record );
+    record->Magic = FAULT_MAGIC_PENDING;
+    __DSB ( );
+    if ( ( CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk ) != 0 ) {
+        __BKPT ( 0 ); // stop here when a debugger is attached, the dump is already saved
+    }
+    NVIC_SystemReset ( );
+}
+
+/********************************************************************/
+/*                              Api                                 */
+/********************************************************************/
+const McuFaultRecord_t * McuFaultLast ( void ) {
+    // SRAM2 holds random data after a power on : both the magic and the crc have to match
+    if ( ( ( FaultRecord.Magic != FAULT_MAGIC_PENDING ) && ( FaultRecord.Magic != FAULT_MAGIC_REPORTED ) )
+      || ( FaultRecord.StackWords > FAULT_STACK_WORDS ) || ( FaultRecord.TraceBytes > FAULT_TRACE_BYTES )
+      || ( FaultRecord.TraceIdNumber > TRACE_LAST_IDS )
+      || ( FaultRecord.Crc != FaultRecordCrc ( &FaultRecord ) ) ) {
+        return ( NULL );
+    }
+    return ( &FaultRecord );
+}
+
+void McuFaultClear ( void ) {
+    FaultRecord.Magic = 0;
+}
+
+int McuFaultPrint ( void ) {
+    const McuFaultRecord_t * record = McuFaultLast ( );
+    if ( record == NULL ) {
+        mcu.MMprint ( "no crash dump\n" );
+        return ( -1 );
+    }
+    uint32_t exception = record->Exception;
+    mcu.MMprint ( "%s (exception %lu) at %lu ms, interrupted %s %lu\n", FaultName ( exception ), ( unsigned long ) exception,
+                  ( unsigned long ) record->Tick, ( ( record->Psr & 0x1FF ) == 0 ) ? "thread" : "exception",
+                  ( unsigned long ) ( record->Psr & 0x1FF ) );
+    mcu.MMprint ( "pc  %08lx lr  %08lx sp  %08lx psr %08lx exc_return %08lx\n", ( unsigned long ) record->Pc, ( unsigned long ) record->Lr,
+                  ( unsigned long ) record->Sp, ( unsigned long ) record->Psr, ( unsigned long ) record->ExcReturn );
+    mcu.MMprint ( "r0  %08lx r1  %08lx r2  %08lx r3  %08lx r12 %08lx\n", ( unsigned long ) record->R0, ( unsigned long ) record->R1,
+                  ( unsigned long ) record->R2, ( unsigned long ) record->R3, ( unsigned long ) record->R12 );
+    for ( int i = 0; i < 8; i += 4 ) {
+        mcu.MMprint ( "r%-2d %08lx r%-2d %08lx r%-2d %08lx r%-2d %08lx\n", i + 4, ( unsigned long ) record->R4_R11 [ i ],
+                      i + 5, ( unsigned long ) record->R4_R11 [ i + 1 ], i + 6, ( unsigned long ) record->R4_R11 [ i + 2 ],
+                      i + 7, ( unsigned long ) record->R4_R11 [ i + 3 ] );
+    }
+    mcu.MMprint ( "cfsr %08lx hfsr %08lx mmfar %08lx bfar %08lx :", ( unsigned long ) record->Cfsr, ( unsigned long ) record->Hfsr,
+                  ( unsigned long ) record->Mmfar, ( unsigned long ) record->Bfar );
+    for ( int i = 0; i < 32; i++ ) {
+        if ( ( ( record->Cfsr >> i ) & 1 ) && ( CfsrNames [ i ] != 0 ) ) {
+            mcu.MMprint ( " %s", CfsrNames [ i ] );
+        }
+    }
+    if ( ( record->Hfsr & SCB_HFSR_FORCED_Msk ) != 0 ) {
+        mcu.MMprint ( " FORCED" );
+    }
+    mcu.MMprint ( "\n" );
+    mcu.MMprint ( "timer callback %08lx, last trace ids :", ( unsigned long ) record->TimerCallback );
+    for ( uint32_t i = 0; i < record->TraceIdNumber; i++ ) {
+        mcu.MMprint ( " %04x", record->TraceIds [ i ] );
+    }
+    mcu.MMprint ( "\n" );
+    for ( uint32_t i = 0; i < record->StackWords; i++ ) {
+        if ( ( i & 3 ) == 0 ) {
+            mcu.MMprint ( "%08lx:", ( unsigned long ) ( record->Sp + 4 * i ) );
+        }
+        mcu.MMprint ( " %08lx", ( unsigned long ) record->Stack [ i ] );
+        if ( ( ( i & 3 ) == 3 ) || ( i + 1 == record->StackWords ) ) {
+            mcu.MMprint ( "\n" );
+        }
+    }
+    if ( record->TraceBytes > 0 ) {
+        // raw binary frames : Tools/trace_decode.py resyncs on the first complete one
+        mcu.MMprint ( "last %lu trace bytes follow\n", ( unsigned long ) record->TraceBytes );
+        mcu.TraceFlush ( );
+        HAL_UART_Transmit ( &huart2, ( uint8_t * ) record->Trace, record->TraceBytes, 0xffffff );
+    }
+    return ( 0 );
+}
+
+void McuFaultInit ( void ) {
+#if FAULT_DUMP_ENABLE == 1
+    SCB->SHCSR |= SCB_SHCSR_USGFAULTENA_Msk | SCB_SHCSR_BUSFAULTENA_Msk | SCB_SHCSR_MEMFAULTENA_Msk;
+    SCB->CCR   |= SCB_CCR_DIV_0_TRP_Msk;
+#endif
+    const McuFaultRecord_t * record = McuFaultLast ( );
+    if ( ( record != NULL ) && ( record->Magic == FAULT_MAGIC_PENDING ) ) {
+        // a WWDG early wakeup record tells the stalled code path : pc, timer callback and last trace ids
+        MMLOG_ERROR ( MCU, "reset by %s (exception %lu), pc %08lx cfsr %08lx\n", FaultName ( record->Exception ),
+                      ( unsigned long ) record->Exception, ( unsigned long ) record->Pc, ( unsigned long ) record->Cfsr );
+        McuFaultPrint ( );
+        FaultRecord.Magic = FAULT_MAGIC_REPORTED;
+    }
+}
@@ -0,0 +1,85 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Crash dump.
+                    HardFault, MemManage, BusFault and UsageFault share one handler : it records the
+                    stacked registers, the fault status registers, a snapshot of the faulting stack
+                    and the tail of the trace ring buffer in SRAM2, then resets the mcu at once.
+                    The record is in .sram2_noinit (McuSections.h), kept across a system reset and in Standby,
+                    the dump is reported on the next boot by McuFaultInit.
+                    The WWDG early wakeup interrupt shares the handler : the dump then tells which code
+                    path kept the SysTick from refreshing the WWDG.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_FAULT_H
+#define MCU_FAULT_H
+#include "stdint.h"
+#include "UserDefine.h"
+#include "McuTrace.h"
+
+#define FAULT_MAGIC_PENDING  0xDEADFA17U   // dump written, not yet reported
+#define FAULT_MAGIC_REPORTED 0xDEADFA18U   // dump already reported, kept for the console
+
+#ifndef FAULT_STACK_WORDS
+    #define FAULT_STACK_WORDS 32
+#endif
+#ifndef FAULT_TRACE_BYTES
+    #define FAULT_TRACE_BYTES 256
+#endif
+
+typedef struct {
+    uint32_t Magic;
+    uint32_t Exception;    // IPSR : 3 HardFault, 4 MemManage, 5 BusFault, 6 UsageFault, 16 WWDG early wakeup
+    uint32_t Tick;         // HAL_GetTick at the fault
+    uint32_t R0, R1, R2, R3, R12, Lr, Pc, Psr; // stacked by the core
+    uint32_t R4_R11 [ 8 ];
+    uint32_t ExcReturn;
+    uint32_t Sp;           // stack pointer before the exception entry
+    uint32_t Cfsr;
+    uint32_t Hfsr;
+    uint32_t Mmfar;
+    uint32_t Bfar;
+    uint32_t TimerCallback; // low power timer callback armed at the fault
+    uint32_t TraceIdNumber;
+    uint16_t TraceIds [ TRACE_LAST_IDS ]; // ids of the last MMTRACE, the most recent first
+    uint32_t StackWords;
+    uint32_t Stack [ FAULT_STACK_WORDS ];
+    uint32_t TraceBytes;
+    uint8_t  Trace [ FAULT_TRACE_BYTES ];
+    uint32_t Crc;          // crc32 of the fields between Magic and Crc
+} McuFaultRecord_t;
+
+/*!
+ * McuFaultInit : report the dump left by the previous reset
+ *                and, with FAULT_DUMP_ENABLE, enable the MemManage, BusFault, UsageFault and divide by zero traps
+ * \remark called once by InitMcu, after the debug uart is initialized
+ */
+void                     McuFaultInit    ( void );
+
+/*!
+ * McuFaultPrint : print the last dump, reported or not
+ * \param [OUT] int 0 if a valid dump was printed, -1 otherwise
+ */
+int                      McuFaultPrint   ( void );
+
+/*!
+ * McuFaultLast : last valid dump, NULL if none
+ */
+const McuFaultRecord_t * McuFaultLast    ( void );
+
+/*!
+ * McuFaultClear : forget the last dump
+ */
+void                     McuFaultClear   ( void );
+
+#endif
@@ -0,0 +1,31 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : HAL of the STM32 family selected by the build, for the Mcu files shared by the families.
+                    MCU_STM32L0 selects the STM32L0 (Cortex-M0+), the STM32L4 (Cortex-M4) otherwise.
+                        MCU_HAS_DWT  1 when the core has the DWT cycle counter, used by McuProfile,
+                                     McuIsrStats and McuEnergy : these files are not built for the STM32L0
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_HAL_H
+#define MCU_HAL_H
+
+#if defined ( MCU_STM32L0 )
+    #include "stm32l0xx_hal.h"
+    #define MCU_HAS_DWT 0
+#else
+    #include "stm32l4xx_hal.h"
+    #define MCU_HAS_DWT 1
+#endif
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Interrupt latency and duration histograms.
+
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#include "McuIsrStats.h"
+#include "ApiMcu.h"
+#include "stm32l4xx_hal.h"
+#include "string.h"
+#include "McuSections.h"
+
+McuIsrStat_t McuIsrStats [ ISR_STAT_NUMBER ];
+
+static const char * const IsrNames [ ISR_STAT_NUMBER ] = { "SysTick", "LPTIM1", "Radio", "RTC_WKUP", "I2C1_EV", "USART2", "DMA1_CH6" };
+static uint32_t           IsrLptimCyclesPerTick = 1;
+
+void McuIsrStatsInit ( void ) {
+    uint32_t lptimClock = HAL_RCCEx_GetPeriphCLKFreq ( RCC_PERIPHCLK_LPTIM1 ) >> ( ( LPTIM1->CFGR & LPTIM_CFGR_PRESC ) >> LPTIM_CFGR_PRESC_Pos );
+    IsrLptimCyclesPerTick = ( lptimClock == 0 ) ? 1 : ( SystemCoreClock + lptimClock / 2 ) / lptimClock;
+    McuProfileInit ( );
+}
+
+MCU_RAMFUNC uint32_t McuIsrLatencySysTick ( void ) {
+    // the counter reloads and pends the exception when it reaches 0, it counts down since
+    return ( SysTick->LOAD - SysTick->VAL );
+}
+
+MCU_RAMFUNC uint32_t McuIsrLatencyLptim1 ( void ) {
+    // the counter may run on an asynchronous clock : two identical reads are needed
+    uint32_t count;
+    do {
+        count = LPTIM1->CNT;
+    } while ( count != LPTIM1->CNT );
+    return ( ( uint16_t ) ( count - LPTIM1->CMP ) * IsrLptimCyclesPerTick );
+}
+
+MCU_RAMFUNC void McuIsrRecordLatency ( uint8_t vector, uint32_t latency ) {
+    McuIsrStat_t * stat = &McuIsrStats [ vector ];
+    stat->LatencyCount++;
+    stat->Latency [ McuIsrBucket ( latency ) ]++;
+    if ( latency > stat->LatencyMax ) {
+        stat->LatencyMax = latency;
+    }
+}
+
+MCU_RAMFUNC void McuIsrRecordDuration ( uint8_t vector, uint32_t start ) {
+    uint32_t       duration = McuProfileNow ( ) - start;
+    McuIsrStat_t * stat = &McuIsrStats [ vector ];
+    stat->Count++;
+    stat->Duration [ McuIsrBucket ( duration ) ]++;
+    if ( duration > stat->DurationMax ) {
+        stat->DurationMax = duration;
+    }
+}
+
+static void IsrPrintHistogram ( const char * label, const uint32_t * buckets, uint32_t max ) {
+    mcu.MMprint ( "  %s max %lu :", label, ( unsigned long ) max );
+    for ( int i = 0; i < ISR_STATS_BUCKETS; i++ ) {
+        if ( buckets [ i ] != 0 ) {
+            mcu.MMprint ( " <%lu:%lu", ( unsigned long ) ( 1UL << i ), ( unsigned long ) buckets [ i ] );
+        }
+    }
+    mcu.MMprint ( "\n" );
+}
+
+void McuIsrStatsPrint ( void ) {
+    mcu.MMprint ( "isr histograms in cycles, %lu cycles per us\n", ( unsigned long ) ( SystemCoreClock / 1000000 ) );
+    for ( int i = 0; i < ISR_STAT_NUMBER; i++ ) {
+        // copy first : the handlers keep running while printing
+        McuIsrStat_t stat = McuIsrStats [ i ];
+        if ( stat.Count == 0 ) {
+            continue;
+        }
+        mcu.MMprint ( "%s %lu calls\n", IsrNames [ i ], ( unsigned long ) stat.Count );
+        IsrPrintHistogram ( "duration", stat.Duration, stat.DurationMax );
+        if ( stat.LatencyCount != 0 ) {
+            IsrPrintHistogram ( "latency ", stat.Latency, stat.LatencyMax );
+        }
+    }
+}
+
+void McuIsrStatsReset ( void ) {
+    memset ( McuIsrStats, 0, sizeof ( McuIsrStats ) );
+}
@@ -0,0 +1,108 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Interrupt latency and duration histograms.
+                    MMISR ( vector ) at the top of a handler measures its execution time with the DWT
+                    cycle counter, MMISR_LATENCY ( vector, cycles ) also records the delay between the
+                    pending event and the handler entry. Both go to log2 histograms, bucket k counts
+                    the values in [ 2^(k-1), 2^k ) cycles.
+                    The latency is only known when the peripheral keeps a timestamp of the event :
+                    SysTick (LOAD - VAL) and LPTIM1 (CNT - CMP). The other vectors only get a duration.
+                    With ISR_STATS_ENABLE = 0 (UserDefine.h) the wrappers are removed at compile time.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_ISR_STATS_H
+#define MCU_ISR_STATS_H
+#include "stdint.h"
+#include "UserDefine.h"
+#include "McuProfile.h"
+
+#if ( ISR_STATS_ENABLE == 1 ) && defined ( MCU_STM32L0 )
+    #error "ISR_STATS_ENABLE needs the DWT cycle counter, the Cortex-M0+ of the STM32L0 has none"
+#endif
+
+#define ISR_STATS_BUCKETS 24 // up to 2^23 cycles, 131 ms at 64 MHz, longer values go to the last bucket
+
+enum {
+    ISR_STAT_SYSTICK = 0,
+    ISR_STAT_LPTIM1,
+    ISR_STAT_RADIO,     // EXTI vectors of the radio lines, IrqHandlerRadio
+    ISR_STAT_RTC_WKUP,
+    ISR_STAT_I2C1_EV,
+    ISR_STAT_USART2,
+    ISR_STAT_DMA1_CH6,
+    ISR_STAT_NUMBER
+};
+
+typedef struct {
+    uint32_t Count;
+    uint32_t LatencyCount;
+    uint32_t DurationMax;
+    uint32_t LatencyMax;
+    uint32_t Duration [ ISR_STATS_BUCKETS ];
+    uint32_t Latency [ ISR_STATS_BUCKETS ];
+} McuIsrStat_t;
+
+extern McuIsrStat_t McuIsrStats [ ISR_STAT_NUMBER ];
+
+/*!
+ * McuIsrStatsInit : start the cycle counter and compute the LPTIM1 tick to cycles ratio
+ * \remark have to be called after the clock configuration
+ */
+void     McuIsrStatsInit        ( void );
+
+/*!
+ * McuIsrStatsPrint : print the non empty histograms, McuIsrStatsReset : clear them
+ */
+void     McuIsrStatsPrint       ( void );
+void     McuIsrStatsReset       ( void );
+
+/*!
+ * Latency sources, to be read first thing in the handler
+ */
+uint32_t McuIsrLatencySysTick   ( void );
+uint32_t McuIsrLatencyLptim1    ( void );
+
+static inline uint32_t McuIsrBucket ( uint32_t value ) {
+    uint32_t bucket = ( value == 0 ) ? 0 : 32 - __builtin_clz ( value );
+    return ( ( bucket < ISR_STATS_BUCKETS ) ? bucket : ISR_STATS_BUCKETS - 1 );
+}
+
+/*!
+ * McuIsrRecordLatency / McuIsrRecordDuration : histogram updates of McuIsrScope
+ * \remark run from SRAM2 with the handlers they measure, see McuSections.h
+ */
+void     McuIsrRecordLatency    ( uint8_t vector, uint32_t latency );
+void     McuIsrRecordDuration   ( uint8_t vector, uint32_t start );
+
+class McuIsrScope {
+public :
+    explicit McuIsrScope ( uint8_t vector ) : Vector ( vector ), Start ( McuProfileNow ( ) ) { };
+    McuIsrScope ( uint8_t vector, uint32_t latency ) : Vector ( vector ), Start ( McuProfileNow ( ) ) {
+        McuIsrRecordLatency ( vector, latency );
+    };
+    ~McuIsrScope ( ) { McuIsrRecordDuration ( Vector, Start ); };
+private :
+    uint8_t  Vector;
+    uint32_t Start;
+};
+
+#if ISR_STATS_ENABLE == 1
+    #define MMISR( vector )                   McuIsrScope IsrScope ( vector )
+    #define MMISR_LATENCY( vector, latency )  McuIsrScope IsrScope ( vector, latency )
+#else
+    #define MMISR( vector )
+    #define MMISR_LATENCY( vector, latency )
+#endif
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Leveled logs runtime thresholds.
+
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#include "McuLog.h"
+#include "string.h"
+
+volatile uint8_t McuLogThreshold [ LOG_MODULE_NUMBER ] = {
+    LOG_LEVEL_MCU,
+    LOG_LEVEL_FLASH,
+    LOG_LEVEL_RADIO,
+    LOG_LEVEL_MAC,
+    LOG_LEVEL_APP
+};
+
+static const char * const LogModuleNames [ LOG_MODULE_NUMBER ] = { "mcu", "flash", "radio", "mac", "app" };
+static const char * const LogLevelNames [ LOG_LEVEL_TRACE + 1 ] = { "none", "error", "warn", "info", "debug", "trace" };
+
+int McuLogSetLevel ( int module, int level ) {
+    if ( ( module < 0 ) || ( module >= LOG_MODULE_NUMBER ) || ( level < LOG_LEVEL_NONE ) || ( level > LOG_LEVEL_TRACE ) ) {
+        return ( -1 );
+    }
+    McuLogThreshold [ module ] = ( uint8_t ) level;
+    return ( 0 );
+}
+
+int McuLogGetLevel ( int module ) {
+    if ( ( module < 0 ) || ( module >= LOG_MODULE_NUMBER ) ) {
+        return ( -1 );
+    }
+    return ( McuLogThreshold [ module ] );
+}
+
+const char * McuLogModuleName ( int module ) {
+    return ( ( ( module < 0 ) || ( module >= LOG_MODULE_NUMBER ) ) ? "?" : LogModuleNames [ module ] );
+}
+
+const char * McuLogLevelName ( int level ) {
+    return ( ( ( level < LOG_LEVEL_NONE ) || ( level > LOG_LEVEL_TRACE ) ) ? "?" : LogLevelNames [ level ] );
+}
+
+int McuLogFindModule ( const char * name ) {
+    for ( int i = 0; i < LOG_MODULE_NUMBER; i++ ) {
+        if ( strcmp ( name, LogModuleNames [ i ] ) == 0 ) {
+            return ( i );
+        }
+    }
+    return ( -1 );
+}
@@ -0,0 +1,92 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Leveled logs with per module thresholds.
+                    MMLOG_INFO ( FLASH, "fmt", args ) is removed at compile time, arguments included,
+                    when LOG_LEVEL_FLASH (UserDefine.h) is lower than INFO. Otherwise a one byte
+                    runtime threshold, changed with McuLogSetLevel, is checked before MMTRACE.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_LOG_H
+#define MCU_LOG_H
+#include "stdint.h"
+
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+#define LOG_LEVEL_TRACE 5
+
+#include "UserDefine.h"
+#include "McuTrace.h"
+
+/* Compile time thresholds, override them in UserDefine.h */
+#ifndef LOG_LEVEL_MCU
+    #define LOG_LEVEL_MCU   LOG_LEVEL_INFO
+#endif
+#ifndef LOG_LEVEL_FLASH
+    #define LOG_LEVEL_FLASH LOG_LEVEL_INFO
+#endif
+#ifndef LOG_LEVEL_RADIO
+    #define LOG_LEVEL_RADIO LOG_LEVEL_INFO
+#endif
+#ifndef LOG_LEVEL_MAC
+    #define LOG_LEVEL_MAC   LOG_LEVEL_INFO
+#endif
+#ifndef LOG_LEVEL_APP
+    #define LOG_LEVEL_APP   LOG_LEVEL_INFO
+#endif
+
+enum {
+    LOG_MODULE_MCU = 0,
+    LOG_MODULE_FLASH,
+    LOG_MODULE_RADIO,
+    LOG_MODULE_MAC,
+    LOG_MODULE_APP,
+    LOG_MODULE_NUMBER
+};
+
+/*!
+ * Runtime thresholds, one byte per module, initialized with the compile time thresholds
+ */
+extern volatile uint8_t McuLogThreshold [ LOG_MODULE_NUMBER ];
+
+/*!
+ * McuLogSetLevel : change the runtime threshold of a module
+ * \remark a level above the compile time threshold of the module has no effect on the removed logs
+ * \param [IN]  int module LOG_MODULE_xxx
+ * \param [IN]  int level  LOG_LEVEL_xxx
+ * \param [OUT] int 0 on success, -1 if the module or the level is unknown
+ */
+int          McuLogSetLevel     ( int module, int level );
+int          McuLogGetLevel     ( int module );
+const char * McuLogModuleName   ( int module );
+const char * McuLogLevelName    ( int level );
+int          McuLogFindModule   ( const char * name );
+
+/* the module name is pasted before any expansion : FLASH or RTC are also register macros */
+#define MMLOG_CHECK( compileLevel, module, level, fmt, ... )                                  \
+    do {                                                                                     \
+        if ( ( compileLevel >= level ) && ( McuLogThreshold [ module ] >= level ) ) {        \
+            MMTRACE ( fmt, ##__VA_ARGS__ );                                                  \
+        }                                                                                    \
+    } while ( 0 )
+
+#define MMLOG_ERROR( module, fmt, ... ) MMLOG_CHECK ( LOG_LEVEL_##module, LOG_MODULE_##module, LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__ )
+#define MMLOG_WARN( module, fmt, ... )  MMLOG_CHECK ( LOG_LEVEL_##module, LOG_MODULE_##module, LOG_LEVEL_WARN,  fmt, ##__VA_ARGS__ )
+#define MMLOG_INFO( module, fmt, ... )  MMLOG_CHECK ( LOG_LEVEL_##module, LOG_MODULE_##module, LOG_LEVEL_INFO,  fmt, ##__VA_ARGS__ )
+#define MMLOG_DEBUG( module, fmt, ... ) MMLOG_CHECK ( LOG_LEVEL_##module, LOG_MODULE_##module, LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__ )
+#define MMLOG_TRACE( module, fmt, ... ) MMLOG_CHECK ( LOG_LEVEL_##module, LOG_MODULE_##module, LOG_LEVEL_TRACE, fmt, ##__VA_ARGS__ )
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Stack and heap usage.
+
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#include "McuMemory.h"
+#include "ApiMcu.h"
+#include "stm32l4xx_hal.h"
+#include "errno.h"
+#include "stddef.h"
+
+/* linker script symbols, only their address is meaningful */
+extern "C" {
+    extern uint8_t _end;
+    extern uint8_t _estack;
+    extern uint8_t _Min_Stack_Size;
+    extern uint8_t _Min_Heap_Size;
+}
+
+static uint8_t * HeapBreak = &_end;
+static uint8_t * HeapPeakBreak = &_end;
+
+extern "C" void * _sbrk ( ptrdiff_t increment ) {
+    uint8_t * previous = HeapBreak;
+    uint8_t * next = previous + increment;
+    if ( next > ( uint8_t * ) __get_MSP ( ) - HEAP_STACK_MARGIN ) {
+        errno = ENOMEM;
+        return ( ( void * ) -1 );
+    }
+    HeapBreak = next;
+    if ( next > HeapPeakBreak ) {
+        HeapPeakBreak = next;
+    }
+    return ( previous );
+}
+
+uint32_t McuStackHighWaterMark ( void ) {
+    // the heap peak is not painted anymore : start the search above it
+    const uint32_t * word = ( const uint32_t * ) ( ( ( uintptr_t ) HeapPeakBreak + 3 ) & ~( uintptr_t ) 3 );
+    const uint32_t * top = ( const uint32_t * ) &_estack;
+    while ( ( word < top ) && ( *word == STACK_PAINT_PATTERN ) ) {
+        word++;
+    }
+    return ( ( uint32_t ) ( ( const uint8_t * ) top - ( const uint8_t * ) word ) );
+}
+
+uint32_t McuStackReserved ( void ) {
+    return ( ( uint32_t ) ( uintptr_t ) &_Min_Stack_Size );
+}
+
+uint32_t McuHeapReserved ( void ) {
+    return ( ( uint32_t ) ( uintptr_t ) &_Min_Heap_Size );
+}
+
+uint32_t McuHeapUsed ( void ) {
+    return ( ( uint32_t ) ( HeapBreak - &_end ) );
+}
+
+uint32_t McuHeapPeak ( void ) {
+    return ( ( uint32_t ) ( HeapPeakBreak - &_end ) );
+}
+
+void McuMemoryPrint ( void ) {
+    uint32_t stack = McuStackHighWaterMark ( );
+    mcu.MMprint ( "stack peak %lu bytes, reserved %lu, free ram between heap and stack %lu\n", ( unsigned long ) stack,
+                  ( unsigned long ) McuStackReserved ( ),
+                  ( unsigned long ) ( ( uint32_t ) ( &_estack - HeapPeakBreak ) - stack ) );
+    mcu.MMprint ( "heap %lu bytes, peak %lu, reserved %lu\n", ( unsigned long ) McuHeapUsed ( ),
+                  ( unsigned long ) McuHeapPeak ( ), ( unsigned long ) McuHeapReserved ( ) );
+}
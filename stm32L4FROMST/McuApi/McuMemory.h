@@ -0,0 +1,50 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Stack and heap usage.
+                    Reset_Handler paints the RAM between the end of .bss and the top of the stack with
+                    STACK_PAINT_PATTERN, the deepest stack use is the lowest word that lost the pattern.
+                    The heap grows through _sbrk, defined here to keep the current and the peak break
+                    and to refuse to grow into the stack.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_MEMORY_H
+#define MCU_MEMORY_H
+#include "stdint.h"
+
+#define STACK_PAINT_PATTERN 0xA5A5A5A5U // also written by startup_stm32l476xx.s
+#define HEAP_STACK_MARGIN   256         // bytes kept free below the stack pointer when the heap grows
+
+/*!
+ * McuStackHighWaterMark : deepest stack use since the reset, in bytes
+ */
+uint32_t McuStackHighWaterMark ( void );
+
+/*!
+ * McuStackReserved / McuHeapReserved : _Min_Stack_Size and _Min_Heap_Size of the linker script
+ */
+uint32_t McuStackReserved      ( void );
+uint32_t McuHeapReserved       ( void );
+
+/*!
+ * McuHeapUsed : current heap size, McuHeapPeak : largest heap size since the reset, in bytes
+ */
+uint32_t McuHeapUsed           ( void );
+uint32_t McuHeapPeak           ( void );
+
+/*!
+ * McuMemoryPrint : print the stack and heap usage against the linker reservations
+ */
+void     McuMemoryPrint        ( void );
+
+#endif
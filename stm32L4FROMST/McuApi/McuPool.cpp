@@ -0,0 +1,140 @@
+/*
+ __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Fixed block memory pools.
+
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#include "McuPool.h"
+#include "ApiMcu.h"
+#include "McuCritical.h"
+#include "McuSections.h"
+#include "stddef.h"
+
+#if ( POOL_64_BLOCKS < 1 ) || ( POOL_256_BLOCKS < 1 ) || ( POOL_2048_BLOCKS < 1 )
+    #error "each pool needs at least one block"
+#endif
+
+typedef struct PoolBlock {
+    struct PoolBlock * Next;
+} PoolBlock_t;
+
+typedef struct {
+    uint8_t *     Base;
+    PoolBlock_t * Free;
+    McuPoolStat_t Stat;
+} Pool_t;
+
+/* uint64_t keeps the blocks 8 bytes aligned, like malloc */
+MCU_SRAM2_BSS static uint64_t Pool64   [ POOL_64_BLOCKS * 64 / 8 ];
+MCU_SRAM2_BSS static uint64_t Pool256  [ POOL_256_BLOCKS * 256 / 8 ];
+MCU_SRAM2_BSS static uint64_t Pool2048 [ POOL_2048_BLOCKS * 2048 / 8 ];
+
+static Pool_t   Pools [ POOL_NUMBER ] = {
+    { ( uint8_t * ) Pool64,   NULL, { 64,   POOL_64_BLOCKS,   0, 0, 0, 0 } },
+    { ( uint8_t * ) Pool256,  NULL, { 256,  POOL_256_BLOCKS,  0, 0, 0, 0 } },
+    { ( uint8_t * ) Pool2048, NULL, { 2048, POOL_2048_BLOCKS, 0, 0, 0, 0 } },
+};
+static uint32_t PoolFailures = 0;
+static int      PoolReady = 0;
+
+/* the free lists are built at the first request : MMprint may allocate before any init function runs */
+static void PoolInit ( void ) {
+    for ( int p = 0; p < POOL_NUMBER; p++ ) {
+        Pool_t * pool = &Pools [ p ];
+        pool->Free = NULL;
+        for ( int i = pool->Stat.Blocks - 1; i >= 0; i-- ) {
+            PoolBlock_t * block = ( PoolBlock_t * ) ( pool->Base + i * pool->Stat.BlockSize );
+            block->Next = pool->Free;
+            pool->Free = block;
+        }
+    }
+    PoolReady = 1;
+}
+
+void * McuPoolAlloc ( uint32_t size ) {
+    PoolBlock_t * block = NULL;
+    uint32_t primask = McuEnterCritical ( );
+    if ( PoolReady == 0 ) {
+        PoolInit ( );
+    }
+    for ( int p = 0; ( p < POOL_NUMBER ) && ( block == NULL ); p++ ) {
+        Pool_t * pool = &Pools [ p ];
+        if ( size > pool->Stat.BlockSize ) {
+            continue;
+        }
+        if ( ( p == POOL_2048 ) && ( size <= Pools [ POOL_256 ].Stat.BlockSize ) ) {
+            break; // reserved to the page copies
+        }
+        if ( pool->Free == NULL ) {
+            pool->Stat.Exhausted++;
+            continue;
+        }
+        block = pool->Free;
+        pool->Free = block->Next;
+        pool->Stat.Allocs++;
+        if ( ++pool->Stat.Used > pool->Stat.Peak ) {
+            pool->Stat.Peak = pool->Stat.Used;
+        }
+    }
+    if ( block == NULL ) {
+        PoolFailures++;
+    }
+    McuExitCritical ( primask );
+    return ( block );
+}
+
+void McuPoolFree ( void * block ) {
+    if ( block == NULL ) {
+        return;
+    }
+    uint32_t primask = McuEnterCritical ( );
+    for ( int p = 0; p < POOL_NUMBER; p++ ) {
+        Pool_t * pool = &Pools [ p ];
+        uintptr_t offset = ( uintptr_t ) block - ( uintptr_t ) pool->Base;
+        if ( ( ( uint8_t * ) block >= pool->Base ) && ( offset < pool->Stat.Blocks * pool->Stat.BlockSize )
+          && ( ( offset % pool->Stat.BlockSize ) == 0 ) ) {
+            PoolBlock_t * free = ( PoolBlock_t * ) block;
+            free->Next = pool->Free;
+            pool->Free = free;
+            pool->Stat.Used--;
+            McuExitCritical ( primask );
+            return;
+        }
+    }
+    PoolFailures++;
+    McuExitCritical ( primask );
+}
+
+void McuPoolGetStat ( int pool, McuPoolStat_t * stat ) {
+    uint32_t primask = McuEnterCritical ( );
+    *stat = Pools [ pool ].Stat;
+    McuExitCritical ( primask );
+}
+
+uint32_t McuPoolFailures ( void ) {
+    return ( PoolFailures );
+}
+
+void McuPoolPrint ( void ) {
+    McuPoolStat_t stats [ POOL_NUMBER ];
+    for ( int p = 0; p < POOL_NUMBER; p++ ) {
+        McuPoolGetStat ( p, &stats [ p ] );
+    }
+    uint32_t failures = PoolFailures;
+    for ( int p = 0; p < POOL_NUMBER; p++ ) {
+        mcu.MMprint ( "pool %4lu B : %lu/%lu used, peak %lu, %lu allocs, exhausted %lu\n", ( unsigned long ) stats [ p ].BlockSize,
+                      ( unsigned long ) stats [ p ].Used, ( unsigned long ) stats [ p ].Blocks, ( unsigned long ) stats [ p ].Peak,
+                      ( unsigned long ) stats [ p ].Allocs, ( unsigned long ) stats [ p ].Exhausted );
+    }
+    mcu.MMprint ( "pool failures %lu\n", ( unsigned long ) failures );
+}
@@ -0,0 +1,83 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Fixed block memory pools for the Mcu layer buffers.
+                    Three block sizes (64, 256 and 2048 bytes), their number set in UserDefine.h, in
+                    SRAM2. A request is served by the smallest size that fits, or by the 256 bytes pool
+                    when the 64 bytes one is empty. The 2048 bytes blocks are kept for the requests that
+                    need them (flash page copy) : a log line can not make a flash write fail. Each pool is a free list : alloc and free are O(1), in a short
+                    critical section, from the main loop or an ISR. The heap is not used.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_POOL_H
+#define MCU_POOL_H
+#include "stdint.h"
+#include "UserDefine.h"
+
+#ifndef POOL_64_BLOCKS
+    #define POOL_64_BLOCKS   8
+#endif
+#ifndef POOL_256_BLOCKS
+    #define POOL_256_BLOCKS  4
+#endif
+#ifndef POOL_2048_BLOCKS
+    #define POOL_2048_BLOCKS 1
+#endif
+
+enum {
+    POOL_64 = 0,
+    POOL_256,
+    POOL_2048,
+    POOL_NUMBER
+};
+
+typedef struct {
+    uint32_t BlockSize;
+    uint32_t Blocks;
+    uint32_t Used;
+    uint32_t Peak;
+    uint32_t Allocs;
+    uint32_t Exhausted;   // requests this pool should have served while it was empty
+} McuPoolStat_t;
+
+/*!
+ * McuPoolAlloc : get a block of at least size bytes, 8 bytes aligned
+ * \param [IN]  size   bytes needed
+ * \param [OUT] return the block, NULL if no pool can serve the request
+ */
+void * McuPoolAlloc    ( uint32_t size );
+
+/*!
+ * McuPoolFree : give back a block from McuPoolAlloc
+ * \remark NULL is ignored, an address out of the pools is ignored and counted in McuPoolFailures
+ */
+void   McuPoolFree     ( void * block );
+
+/*!
+ * McuPoolGetStat : usage of one pool
+ * \param [IN]  pool   POOL_64, POOL_256 or POOL_2048
+ * \param [OUT] stat   counters since the reset
+ */
+void   McuPoolGetStat  ( int pool, McuPoolStat_t * stat );
+
+/*!
+ * McuPoolFailures : requests that no pool could serve and frees of unknown blocks
+ */
+uint32_t McuPoolFailures ( void );
+
+/*!
+ * McuPoolPrint : print the usage of the pools
+ */
+void   McuPoolPrint    ( void );
+
+#endif
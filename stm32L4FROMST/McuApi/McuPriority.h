@@ -0,0 +1,47 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Interrupt priority map, the only place where NVIC priorities are chosen.
+                    NVIC_PRIORITYGROUP_4 : 16 preemption levels, no sub priority, 0 is the highest.
+                        0      WWDG early wakeup and the faults : always run, even in a critical section
+                        1      free, above the critical sections : such a handler must not use the Mcu layer
+                        2      radio DIO (EXTI) and LPTIM1 : the RX window timing
+                        3      RTC wakeup
+                        4      SysTick : HAL tick, WWDG refresh
+                        5      console DMA and UART
+                        6      I2C
+                        15     PendSV
+                    McuEnterCritical masks the levels NVIC_PRIORITY_CRITICAL and lower with BASEPRI :
+                    the level 0 and 1 handlers keep running, the faults are not escalated to HardFault.
+                    The latency of the RX window interrupts is bounded by the longest level 2 handler
+                    and the longest critical section, whatever the logs and the I2C traffic.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_PRIORITY_H
+#define MCU_PRIORITY_H
+
+#define NVIC_PRIORITY_GROUPING   NVIC_PRIORITYGROUP_4
+
+#define NVIC_PRIORITY_WATCHDOG   0
+#define NVIC_PRIORITY_FAULT      0
+#define NVIC_PRIORITY_RADIO      2
+#define NVIC_PRIORITY_TIMER      2
+#define NVIC_PRIORITY_RTC        3
+#define NVIC_PRIORITY_SYSTICK    4
+#define NVIC_PRIORITY_CONSOLE    5
+#define NVIC_PRIORITY_I2C        6
+#define NVIC_PRIORITY_PENDSV     15
+
+#define NVIC_PRIORITY_CRITICAL   2   // highest level masked by McuEnterCritical
+
+#endif
@@ -0,0 +1,113 @@
+/*
+ __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Cycle counter profiling.
+
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#include "McuProfile.h"
+#include "ApiMcu.h"
+#if defined ( __arm__ )
+    #include "McuHal.h"
+    #include "McuCritical.h"
+    #include "McuSections.h"
+    #if MCU_HAS_DWT == 0
+        #error "McuProfile reads the DWT cycle counter, not built for the STM32L0"
+    #endif
+#else
+    #include <chrono>
+    #if defined ( MCU_POSIX )
+        #include "McuCritical.h"
+    #endif
+#endif
+
+static McuProfileProbe_t * ProfileProbes [ PROFILE_MAX_PROBES ];
+static volatile uint32_t   ProfileProbeNumber = 0;
+
+#if defined ( __arm__ )
+void McuProfileInit ( void ) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL  |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+MCU_RAMFUNC uint32_t McuProfileNow ( void ) {
+    return ( DWT->CYCCNT );
+}
+
+static uint32_t ProfileUnitsPerUs ( void ) {
+    return ( SystemCoreClock / 1000000 );
+}
+#else
+void McuProfileInit ( void ) {
+}
+
+uint32_t McuProfileNow ( void ) {
+    return ( ( uint32_t ) std::chrono::duration_cast < std::chrono::nanoseconds > ( std::chrono::steady_clock::now ( ).time_since_epoch ( ) ).count ( ) );
+}
+
+static uint32_t ProfileUnitsPerUs ( void ) {
+    return ( 1000 );
+}
+
+#if !defined ( MCU_POSIX )
+static inline uint32_t McuEnterCritical ( void ) {
+    return ( 0 );
+}
+
+static inline void McuExitCritical ( uint32_t ) {
+}
+#endif
+#endif
+
+void McuProfileRecord ( McuProfileProbe_t * probe, uint32_t elapsed ) {
+    if ( probe->Registered == 0 ) {
+        uint32_t primask = McuEnterCritical ( ); // only once per probe
+        if ( ( probe->Registered == 0 ) && ( ProfileProbeNumber < PROFILE_MAX_PROBES ) ) {
+            ProfileProbes [ ProfileProbeNumber ] = probe;
+            ProfileProbeNumber = ProfileProbeNumber + 1;
+        }
+        probe->Registered = 1;
+        McuExitCritical ( primask );
+    }
+    probe->Count++;
+    probe->Total += elapsed;
+    if ( elapsed < probe->Min ) {
+        probe->Min = elapsed;
+    }
+    if ( elapsed > probe->Max ) {
+        probe->Max = elapsed;
+    }
+}
+
+void McuProfilePrint ( void ) {
+    uint32_t perUs = ProfileUnitsPerUs ( );
+    mcu.MMprint ( "%-16s %10s %10s %10s %10s (%lu units per us)\n", "probe", "count", "min", "mean", "max", ( unsigned long ) perUs );
+    for ( uint32_t i = 0; i < ProfileProbeNumber; i++ ) {
+        McuProfileProbe_t * probe = ProfileProbes [ i ];
+        if ( probe->Count == 0 ) {
+            mcu.MMprint ( "%-16s %10lu\n", probe->Name, 0UL );
+            continue;
+        }
+        mcu.MMprint ( "%-16s %10lu %10lu %10lu %10lu\n", probe->Name, ( unsigned long ) probe->Count, ( unsigned long ) probe->Min,
+                      ( unsigned long ) ( probe->Total / probe->Count ), ( unsigned long ) probe->Max );
+    }
+}
+
+void McuProfileReset ( void ) {
+    for ( uint32_t i = 0; i < ProfileProbeNumber; i++ ) {
+        ProfileProbes [ i ]->Count = 0;
+        ProfileProbes [ i ]->Min   = 0xFFFFFFFF;
+        ProfileProbes [ i ]->Max   = 0;
+        ProfileProbes [ i ]->Total = 0;
+    }
+}
@@ -0,0 +1,86 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Cycle counter profiling.
+                    MMPROFILE ( "name" ) measures the enclosing scope with the DWT cycle counter and
+                    keeps count / min / max / total in a static probe, registered in a table at its
+                    first use. On the host the same probes count nanoseconds with std::chrono.
+                    The STM32L0 has no DWT : PROFILE_ENABLE is 0 there and McuProfile.cpp is not built.
+                    With PROFILE_ENABLE = 0 (UserDefine.h) the probes are removed at compile time.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_PROFILE_H
+#define MCU_PROFILE_H
+#include "stdint.h"
+#include "UserDefine.h"
+
+#if ( PROFILE_ENABLE == 1 ) && defined ( MCU_STM32L0 )
+    #error "PROFILE_ENABLE needs the DWT cycle counter, the Cortex-M0+ of the STM32L0 has none"
+#endif
+
+#define PROFILE_MAX_PROBES 16
+
+typedef struct McuProfileProbe {
+    const char * Name;
+    uint32_t     Count;
+    uint32_t     Min;
+    uint32_t     Max;
+    uint64_t     Total;
+    uint8_t      Registered;
+} McuProfileProbe_t;
+
+/*!
+ * McuProfileInit : start the DWT cycle counter
+ */
+void         McuProfileInit     ( void );
+
+/*!
+ * McuProfileNow : current time in profiling units, cycles on target, nanoseconds on the host
+ */
+uint32_t     McuProfileNow      ( void );
+
+/*!
+ * McuProfileRecord : add one measure to a probe
+ * \remark no lock : a probe has to be used from a single interrupt level
+ * \param [IN]  McuProfileProbe_t* probe
+ * \param [IN]  uint32_t           elapsed  in profiling units
+ */
+void         McuProfileRecord   ( McuProfileProbe_t * probe, uint32_t elapsed );
+
+/*!
+ * McuProfilePrint : print all the probes, McuProfileReset : clear their statistics
+ */
+void         McuProfilePrint    ( void );
+void         McuProfileReset    ( void );
+
+class McuProfileScope {
+public :
+    explicit McuProfileScope ( McuProfileProbe_t * probe ) : Probe ( probe ), Start ( McuProfileNow ( ) ) { };
+    ~McuProfileScope ( ) { McuProfileRecord ( Probe, McuProfileNow ( ) - Start ); };
+private :
+    McuProfileProbe_t * Probe;
+    uint32_t            Start;
+};
+
+#define MMPROFILE_CONCAT2( a, b ) a##b
+#define MMPROFILE_CONCAT( a, b )  MMPROFILE_CONCAT2 ( a, b )
+
+#if PROFILE_ENABLE == 1
+    #define MMPROFILE( name )                                                                          \
+        static McuProfileProbe_t MMPROFILE_CONCAT ( ProfileProbe, __LINE__ ) = { name, 0, 0xFFFFFFFF, 0, 0, 0 }; \
+        McuProfileScope MMPROFILE_CONCAT ( ProfileScope, __LINE__ ) ( &MMPROFILE_CONCAT ( ProfileProbe, __LINE__ ) )
+#else
+    #define MMPROFILE( name )
+#endif
+
+#endif
@@ -0,0 +1,53 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Placement of data and code in the 32 KB SRAM2 (0x10000000), see STM32L476RGTx_FLASH.ld.
+                    SRAM2 is on the I-Code/D-Code bus : code runs there with no flash wait state and
+                    keeps running while a flash bank is erased or programmed.
+                        MCU_SRAM2_NOINIT : never touched by the startup code, kept across a system reset
+                                           and in Standby (SRAM2 retention), check it with a magic or a crc
+                        MCU_SRAM2_DATA   : initialized variables, copied from flash by Reset_Handler
+                        MCU_SRAM2_BSS    : zeroed by Reset_Handler, for DMA and scratch buffers
+                        MCU_RAMFUNC      : functions copied from flash by Reset_Handler and run from SRAM2
+                    The STM32L0 has no SRAM2 : the macros are empty, the data stays in the default sections.
+                    Flash code fetched while bank 1 is erased or programmed stalls until BSY clears (up
+                    to 25 ms for a page erase). Run from SRAM2 :
+                        the BSY waits         FlashPageErase and the HAL flash drivers. The flash resident
+                                              calls of FlashPageErase, EepromMcuWriteBuffer and
+                                              WriteFlashWithoutErase (McuEnergyConsumer, McuPool, MMLOG)
+                                              are made while BSY is clear
+                        the radio and timer   EXTI, LPTIM1 and SysTick handlers with IrqHandlerRadio,
+                                              ExtISR, timerISR, McuEventPost, HAL_GPIO_EXTI_Callback,
+                                              McuTaskSignal, MMISR and the HAL lptim, gpio, cortex, wwdg
+                    Still in flash, held off until the end of a bank 1 operation : the USART2, DMA1,
+                    I2C1, RTC and WWDG early wakeup handlers, the fault handlers, and the radio and timer
+                    callbacks when they run in the ISR (EVENT_LOOP_ENABLE = 0).
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_SECTIONS_H
+#define MCU_SECTIONS_H
+
+#if defined ( __arm__ ) && !defined ( MCU_POSIX ) && !defined ( MCU_STM32L0 )
+    #define MCU_SRAM2_NOINIT __attribute__ ( ( section ( ".sram2_noinit" ) ) )
+    #define MCU_SRAM2_DATA   __attribute__ ( ( section ( ".sram2_data" ) ) )
+    #define MCU_SRAM2_BSS    __attribute__ ( ( section ( ".sram2_bss" ) ) )
+    // SRAM2 is out of reach of a bl from the flash : the linker adds the long branch veneers
+    #define MCU_RAMFUNC      __attribute__ ( ( section ( ".ramfunc" ), noinline ) )
+#else
+    #define MCU_SRAM2_NOINIT
+    #define MCU_SRAM2_DATA
+    #define MCU_SRAM2_BSS
+    #define MCU_RAMFUNC
+#endif
+
+#endif
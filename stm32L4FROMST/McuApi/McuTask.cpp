@@ -0,0 +1,142 @@
+/*
+ __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Stackless tasks for the main loop.
+
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#include "McuTask.h"
+#include "ApiMcu.h"
+#include "McuCritical.h"
+#include "McuSections.h"
+#include "stddef.h"
+#if defined ( MCU_POSIX )
+    #define TaskNowMs( )  ( ( uint32_t ) ( McuPosixNowUs ( ) / 1000 ) )
+#else
+    #include "McuHal.h"
+    #define TaskNowMs( )  HAL_GetTick ( )
+#endif
+
+static McuTask_t *       Tasks [ TASK_MAX_NUMBER ];
+static int               TaskNumber = 0;
+static volatile uint32_t TaskSignals = 0;
+static const char * const TaskStateNames [ ] = { "ready", "sleeping", "waiting", "done" };
+
+int McuTaskStart ( McuTask_t * task, const char * name, McuTaskFunc func, void * context ) {
+    if ( TaskNumber >= TASK_MAX_NUMBER ) {
+        return ( -1 );
+    }
+    task->Func    = func;
+    task->Context = context;
+    task->Name    = name;
+    task->Line    = 0;
+    task->State   = TASK_READY;
+    task->Signals = 0;
+    task->Resumes = 0;
+    Tasks [ TaskNumber++ ] = task;
+    return ( 0 );
+}
+
+void McuTaskSleep ( McuTask_t * task, uint32_t ms ) {
+    task->WakeMs = TaskNowMs ( ) + ms;
+}
+
+MCU_RAMFUNC void McuTaskSignal ( uint32_t mask ) {
+    uint32_t primask = McuEnterCritical ( );
+    TaskSignals |= mask;
+    McuExitCritical ( primask );
+}
+
+/* a due task is made ready, the signals it waited for are consumed */
+static int TaskDue ( McuTask_t * task, uint32_t now ) {
+    switch ( task->State ) {
+        case TASK_READY :
+            return ( 1 );
+        case TASK_SLEEPING :
+            return ( ( int32_t ) ( now - task->WakeMs ) >= 0 );
+        case TASK_WAITING : {
+            uint32_t primask = McuEnterCritical ( );
+            uint32_t raised = TaskSignals & task->Signals;
+            TaskSignals &= ~raised;
+            McuExitCritical ( primask );
+            return ( raised != 0 );
+        }
+        default :
+            return ( 0 );
+    }
+}
+
+int McuTaskRun ( void ) {
+    int run = 0;
+    uint32_t now = TaskNowMs ( );
+    for ( int i = 0; i < TaskNumber; i++ ) {
+        McuTask_t * task = Tasks [ i ];
+        if ( TaskDue ( task, now ) != 0 ) {
+            task->Resumes++;
+            task->State = task->Func ( task );
+            run++;
+        }
+    }
+    return ( run );
+}
+
+uint32_t McuTaskNextWakeMs ( void ) {
+    uint32_t now = TaskNowMs ( );
+    uint32_t next = 0xFFFFFFFF;
+    for ( int i = 0; i < TaskNumber; i++ ) {
+        McuTask_t * task = Tasks [ i ];
+        if ( ( task->State == TASK_READY ) || ( ( task->State == TASK_WAITING ) && ( ( TaskSignals & task->Signals ) != 0 ) ) ) {
+            return ( 0 );
+        }
+        if ( task->State == TASK_SLEEPING ) {
+            int32_t delay = ( int32_t ) ( task->WakeMs - now );
+            if ( delay <= 0 ) {
+                return ( 0 );
+            }
+            next = ( ( uint32_t ) delay < next ) ? ( uint32_t ) delay : next;
+        }
+    }
+    return ( next );
+}
+
+void McuTaskPrint ( void ) {
+    uint32_t now = TaskNowMs ( );
+    for ( int i = 0; i < TaskNumber; i++ ) {
+        McuTask_t * task = Tasks [ i ];
+        mcu.MMprint ( "task %-8s %-8s line %4lu, %lu resumes", task->Name, TaskStateNames [ task->State ],
+                      ( unsigned long ) task->Line, ( unsigned long ) task->Resumes );
+        if ( task->State == TASK_SLEEPING ) {
+            mcu.MMprint ( ", due in %ld ms", ( long ) ( int32_t ) ( task->WakeMs - now ) );
+        } else if ( task->State == TASK_WAITING ) {
+            mcu.MMprint ( ", signals %08lx", ( unsigned long ) task->Signals );
+        }
+        mcu.MMprint ( "\n" );
+    }
+    mcu.MMprint ( "signals pending %08lx\n", ( unsigned long ) TaskSignals );
+}
+
+#if !defined ( MCU_POSIX )
+/********************************************************************/
+/*                HAL completion callbacks (weak in the HAL)        */
+/********************************************************************/
+extern "C" MCU_RAMFUNC void HAL_GPIO_EXTI_Callback ( uint16_t GPIO_Pin ) {
+    McuTaskSignal ( GPIO_Pin ); // one bit per EXTI line, TASK_SIGNAL_PIN
+}
+
+extern "C" void HAL_SPI_TxRxCpltCallback ( SPI_HandleTypeDef * hspi ) {
+    McuTaskSignal ( TASK_SIGNAL_SPI_DMA );
+}
+
+extern "C" void HAL_FLASH_EndOfOperationCallback ( uint32_t ReturnValue ) {
+    McuTaskSignal ( TASK_SIGNAL_FLASH );
+}
+#endif
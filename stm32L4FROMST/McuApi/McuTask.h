@@ -0,0 +1,115 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Stackless tasks for the main loop (protothreads).
+                    A sequence with waits is written as linear code instead of a chain of callbacks :
+                        static McuTask_t SensorTask;   // the whole frame : static, no heap
+                        static int SensorSequence ( McuTask_t * task ) {
+                            MMTASK_BEGIN ( task );
+                            for ( ;; ) {
+                                MMTASK_WAIT_SIGNAL ( task, TASK_SIGNAL_PIN ( 3 ) );
+                                mcu.SetValueDigitalOutPin ( PB_5, 1 );
+                                MMTASK_SLEEP_MS ( task, 200 );
+                                ...
+                            }
+                            MMTASK_END ( task );
+                        }
+                        McuTaskStart ( &SensorTask, "sensor", SensorSequence, NULL );
+                    The body is a switch on the line of the last wait : the local variables are lost
+                    across a wait, keep them in the context or in statics. No switch may be used around
+                    a wait. The tasks run from McuTaskRun in the main loop, the core sleeps in
+                    McuEventIdle while they wait.
+                    Signals are latched bits raised from an ISR with McuTaskSignal : the EXTI lines
+                    (HAL_GPIO_EXTI_Callback), the SPI DMA and the flash interrupt completions.
+                    The compiler has no C++20 coroutines (-std=gnu++14), hence the protothread macros.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_TASK_H
+#define MCU_TASK_H
+#include "stdint.h"
+#include "UserDefine.h"
+
+#ifndef TASK_MAX_NUMBER
+    #define TASK_MAX_NUMBER 8
+#endif
+
+/* Signals : bits 0 to 15 are the EXTI lines */
+#define TASK_SIGNAL_PIN( line )  ( 1UL << ( line ) )
+#define TASK_SIGNAL_SPI_DMA      ( 1UL << 16 )  // HAL_SPI_TxRxCpltCallback
+#define TASK_SIGNAL_FLASH        ( 1UL << 17 )  // HAL_FLASH_EndOfOperationCallback, interrupt mode programming and erase
+#define TASK_SIGNAL_USER( n )    ( 1UL << ( 24 + ( n ) ) ) // n from 0 to 7, free for the application
+
+enum {
+    TASK_READY = 0,   // runs at the next McuTaskRun
+    TASK_SLEEPING,
+    TASK_WAITING,     // for a signal
+    TASK_DONE
+};
+
+typedef struct McuTask McuTask_t;
+typedef int ( * McuTaskFunc ) ( McuTask_t * task );
+
+struct McuTask {
+    McuTaskFunc  Func;
+    void *       Context;
+    const char * Name;
+    uint32_t     Line;       // resume point, 0 at the start
+    uint32_t     State;
+    uint32_t     WakeMs;     // TASK_SLEEPING
+    uint32_t     Signals;    // TASK_WAITING : any of these bits
+    uint32_t     Resumes;
+};
+
+#define MMTASK_BEGIN( task )             switch ( ( task )->Line ) { case 0:
+#define MMTASK_END( task )               } ( task )->Line = 0; return ( TASK_DONE )
+#define MMTASK_YIELD( task )             do { ( task )->Line = __LINE__; return ( TASK_READY ); case __LINE__: ; } while ( 0 )
+#define MMTASK_SLEEP_MS( task, ms )      do { McuTaskSleep ( task, ms ); ( task )->Line = __LINE__; return ( TASK_SLEEPING ); case __LINE__: ; } while ( 0 )
+#define MMTASK_WAIT_SIGNAL( task, mask ) do { ( task )->Signals = ( mask ); ( task )->Line = __LINE__; return ( TASK_WAITING ); case __LINE__: ; } while ( 0 )
+
+/*!
+ * McuTaskStart : register a task, it runs from its beginning at the next McuTaskRun
+ * \remark the McuTask_t has to live as long as the task : a static
+ * \param [OUT] return  0, -1 if TASK_MAX_NUMBER tasks are registered
+ */
+int      McuTaskStart      ( McuTask_t * task, const char * name, McuTaskFunc func, void * context );
+
+/*!
+ * McuTaskRun : resume the tasks ready, woken by their deadline or by a signal
+ * \remark main loop only
+ * \param [OUT] return  number of tasks resumed, 0 when the core can sleep
+ */
+int      McuTaskRun        ( void );
+
+/*!
+ * McuTaskSignal : raise signals, latched until a task waiting for one of them is resumed
+ * \remark from an ISR or the main loop
+ */
+void     McuTaskSignal     ( uint32_t mask );
+
+/*!
+ * McuTaskNextWakeMs : time until the earliest sleeping task is due
+ * \param [OUT] return  ms, 0 if a task is ready, 0xFFFFFFFF if none sleeps
+ */
+uint32_t McuTaskNextWakeMs ( void );
+
+/*!
+ * McuTaskSleep : used by MMTASK_SLEEP_MS
+ */
+void     McuTaskSleep      ( McuTask_t * task, uint32_t ms );
+
+/*!
+ * McuTaskPrint : print the state of the tasks
+ */
+void     McuTaskPrint      ( void );
+
+#endif
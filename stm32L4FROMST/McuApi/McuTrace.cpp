@@ -0,0 +1,147 @@
+/*
+ __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Deferred binary trace ring buffer.
+
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#include "McuTrace.h"
+#include "McuCritical.h"
+#include "McuSections.h"
+#include "McuPool.h"
+#include "stdio.h"
+#if defined ( MCU_POSIX )
+    #define TraceTick( )                     ( ( uint32_t ) ( McuPosixNowUs ( ) / 1000 ) )
+    #define TraceUartWrite( data, length )   McuPosixUartWrite ( data, length )
+#elif defined ( MCU_STM32L0 )
+    #include "McuHal.h"
+    extern UART_HandleTypeDef UartHandle; // ClassSTM32L0.cpp
+    #define TraceTick( )                     HAL_GetTick ( )
+    #define TraceUartWrite( data, length )   HAL_UART_Transmit ( &UartHandle, data, length, 0xffffff )
+#else
+    #include "McuHal.h"
+    #include "usart.h"
+    #define TraceTick( )                     HAL_GetTick ( )
+    #define TraceUartWrite( data, length )   HAL_UART_Transmit ( &huart2, data, length, 0xffffff )
+#endif
+
+#if ( TRACE_RING_SIZE & ( TRACE_RING_SIZE - 1 ) ) != 0
+    #error "TRACE_RING_SIZE have to be a power of 2"
+#endif
+
+MCU_SRAM2_BSS static uint8_t TraceRing [ TRACE_RING_SIZE ];
+static volatile uint32_t TraceHead = 0; // written by McuTracePush
+static volatile uint32_t TraceTail = 0; // written by McuTraceFlush
+static volatile uint32_t TraceDropped = 0;
+static uint16_t          TraceLastIds [ TRACE_LAST_IDS ];
+static uint32_t          TraceIdCount = 0;
+
+static inline void TraceCopy ( uint32_t index, const uint8_t * data, uint32_t length ) {
+    for ( uint32_t i = 0; i < length; i++ ) {
+        TraceRing [ ( index + i ) & ( TRACE_RING_SIZE - 1 ) ] = data [ i ];
+    }
+}
+
+static void TraceWriteFrame ( uint16_t id, uint8_t nargs, const uint8_t * payload, uint32_t length ) {
+    uint32_t tick = TraceTick ( );
+    uint8_t header [ 8 ] = { TRACE_FRAME_SYNC, nargs, ( uint8_t ) ( id & 0xFF ), ( uint8_t ) ( id >> 8 ),
+                             ( uint8_t ) ( tick & 0xFF ), ( uint8_t ) ( ( tick >> 8 ) & 0xFF ),
+                             ( uint8_t ) ( ( tick >> 16 ) & 0xFF ), ( uint8_t ) ( tick >> 24 ) };
+    uint32_t primask = McuEnterCritical ( );
+    TraceLastIds [ TraceIdCount++ % TRACE_LAST_IDS ] = id;
+    uint32_t head = TraceHead;
+    if ( ( TRACE_RING_SIZE - ( head - TraceTail ) ) < ( sizeof ( header ) + length ) ) {
+        TraceDropped++;
+        McuExitCritical ( primask );
+        return;
+    }
+    TraceCopy ( head, header, sizeof ( header ) );
+    TraceCopy ( head + sizeof ( header ), payload, length );
+    TraceHead = head + sizeof ( header ) + length;
+    McuExitCritical ( primask );
+}
+
+void McuTracePush ( uint16_t id, const uint32_t * args, uint8_t nargs ) {
+    // the core is little endian : the words are copied as they are in memory
+    TraceWriteFrame ( id, nargs, ( const uint8_t * ) args, 4 * nargs );
+}
+
+void McuTracePushText ( const char * text, uint32_t length ) {
+    if ( length > 0xFF ) {
+        length = 0xFF;
+    }
+    TraceWriteFrame ( TRACE_ID_TEXT, ( uint8_t ) length, ( const uint8_t * ) text, length );
+}
+
+void McuTracePrint ( const char * fmt, va_list argp ) {
+    char * string = ( char * ) McuPoolAlloc ( TRACE_PRINT_SIZE );
+    if ( string == NULL ) { // counted in the pool failures
+        return;
+    }
+    int length = vsnprintf ( string, TRACE_PRINT_SIZE, fmt, argp );
+    if ( length > 0 ) {
+        length = ( length < TRACE_PRINT_SIZE ) ? length : TRACE_PRINT_SIZE - 1;
+#if BINARY_TRACE == 1
+        McuTracePushText ( string, length ); // keep the order with the MMTRACE frames
+#else
+        TraceUartWrite ( ( uint8_t * ) string, length );
+#endif
+    }
+    McuPoolFree ( string );
+}
+
+void McuTraceFlush ( void ) {
+    uint32_t head = TraceHead;
+    uint32_t tail = TraceTail;
+    while ( tail != head ) {
+        uint32_t index  = tail & ( TRACE_RING_SIZE - 1 );
+        uint32_t length = head - tail;
+        if ( length > ( TRACE_RING_SIZE - index ) ) {
+            length = TRACE_RING_SIZE - index; // send up to the end of the ring, the rest on the next turn
+        }
+        TraceUartWrite ( &TraceRing [ index ], length );
+        tail += length;
+        TraceTail = tail;
+    }
+}
+
+uint32_t McuTraceDropped ( void ) {
+    return ( TraceDropped );
+}
+
+uint32_t McuTraceSnapshot ( uint8_t * buffer, uint32_t size ) {
+    uint32_t head = TraceHead;
+    if ( size > TRACE_RING_SIZE ) {
+        size = TRACE_RING_SIZE;
+    }
+    if ( size > head ) {
+        size = head; // the ring has not been filled once yet
+    }
+    for ( uint32_t i = 0; i < size; i++ ) {
+        buffer [ i ] = TraceRing [ ( head - size + i ) & ( TRACE_RING_SIZE - 1 ) ];
+    }
+    return ( size );
+}
+
+uint32_t McuTraceLastIds ( uint16_t * ids, uint32_t number ) {
+    uint32_t count = TraceIdCount;
+    if ( number > TRACE_LAST_IDS ) {
+        number = TRACE_LAST_IDS;
+    }
+    if ( number > count ) {
+        number = count;
+    }
+    for ( uint32_t i = 0; i < number; i++ ) {
+        ids [ i ] = TraceLastIds [ ( count - 1 - i ) % TRACE_LAST_IDS ];
+    }
+    return ( number );
+}
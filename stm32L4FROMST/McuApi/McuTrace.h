@@ -0,0 +1,124 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Deferred binary trace.
+                    MMTRACE ( "fmt", args ) stores the format string in the non loaded .trace_fmt
+                    section and only pushes its offset, a ms timestamp and the raw 32 bits arguments
+                    to a ring buffer. The text is rebuilt on the host by Tools/trace_decode.py
+                    from the elf file.
+
+                    Frame layout (little endian) :
+                    | 0xA5 | nargs | id (16 bits) | tick ms (32 bits) | nargs x 32 bits |
+                    id TRACE_ID_TEXT carries a MMprint string : nargs is then its length in bytes.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_TRACE_H
+#define MCU_TRACE_H
+#include "stdint.h"
+#include "stdarg.h"
+#include "UserDefine.h"
+
+#define TRACE_FRAME_SYNC   0xA5
+#define TRACE_ID_TEXT      0xFFFF
+#define TRACE_MAX_ARGS     8
+#define TRACE_LAST_IDS     8
+#define TRACE_PRINT_SIZE   256 // one MMprint line, from the 256 bytes pool
+
+/*!
+ * McuTracePush : append one frame to the trace ring buffer
+ * \remark callable from thread and ISR context, the frame is dropped when the ring is full
+ * \param [IN]  uint16_t  id     offset of the format string inside .trace_fmt
+ * \param [IN]  uint32_t* args   raw arguments
+ * \param [IN]  uint8_t   nargs  number of arguments
+ * \param [OUT] void
+ */
+void     McuTracePush       ( uint16_t id, const uint32_t * args, uint8_t nargs );
+
+/*!
+ * McuTracePushText : append an already formatted MMprint string to the trace ring buffer
+ */
+void     McuTracePushText   ( const char * text, uint32_t length );
+
+/*!
+ * McuTracePrint : format a MMprint string in a 256 bytes pool block and send it on the debug uart,
+ *                 or push it to the ring buffer with BINARY_TRACE
+ * \remark the string is cut at TRACE_PRINT_SIZE - 1 characters, nothing is sent when the pool is exhausted
+ * \remark used by the MMprint of the STM32 families
+ */
+void     McuTracePrint      ( const char * fmt, va_list argp );
+
+/*!
+ * McuTraceFlush : send the pending bytes of the ring buffer on the debug uart
+ * \remark have to be called from the main loop, never from an ISR
+ */
+void     McuTraceFlush      ( void );
+
+/*!
+ * McuTraceDropped : number of frames lost because the ring buffer was full
+ */
+uint32_t McuTraceDropped    ( void );
+
+/*!
+ * McuTraceSnapshot : copy the last bytes written in the ring buffer, flushed or not
+ * \remark no lock is taken : used by the fault handler, the copy may start in the middle of a frame
+ * \param [IN]  uint8_t*  buffer
+ * \param [IN]  uint32_t  size   size of buffer in bytes
+ * \param [OUT] uint32_t  number of bytes copied
+ */
+uint32_t McuTraceSnapshot   ( uint8_t * buffer, uint32_t size );
+
+/*!
+ * McuTraceLastIds : ids of the last frames pushed, the most recent first
+ * \remark kept even when the frames are dropped, TRACE_ID_TEXT included
+ * \param [IN]  uint16_t* ids
+ * \param [IN]  uint32_t  number size of ids, at most TRACE_LAST_IDS
+ * \param [OUT] uint32_t  number of ids copied
+ */
+uint32_t McuTraceLastIds    ( uint16_t * ids, uint32_t number );
+
+namespace McuTraceDetail {
+    inline uint32_t Word ( float value ) {
+        union { float f; uint32_t u; } conv;
+        conv.f = value;
+        return ( conv.u );
+    }
+    inline uint32_t Word ( double value ) { return ( Word ( ( float ) value ) ); }
+    template < typename T > inline uint32_t Word ( T * value ) { return ( ( uint32_t ) ( uintptr_t ) value ); }
+    template < typename T > inline uint32_t Word ( T value ) { return ( ( uint32_t ) value ); }
+
+    template < typename... Args >
+    inline void Write ( const char * fmt, Args... args ) {
+        static_assert ( sizeof... ( Args ) <= TRACE_MAX_ARGS, "MMTRACE supports at most TRACE_MAX_ARGS arguments" );
+        const uint32_t words [ sizeof... ( Args ) + 1 ] = { Word ( args )..., 0 };
+        McuTracePush ( ( uint16_t ) ( uintptr_t ) fmt, words, sizeof... ( Args ) );
+    }
+}
+
+/*!
+ * MMTRACE : printf like trace without any formatting on target
+ * \remark fmt must be a string literal, %s is not supported (the decoder prints the pointer)
+ * \remark floating point arguments are sent as 32 bits float
+ */
+#if ( DEBUG_TRACE == 1 ) && ( BINARY_TRACE == 1 )
+#define MMTRACE( fmt, ... )                                                                   \
+    do {                                                                                      \
+        static const char _traceFmt [ ] __attribute__ ( ( section ( ".trace_fmt" ), used ) ) = fmt; \
+        McuTraceDetail::Write ( _traceFmt, ##__VA_ARGS__ );                                   \
+    } while ( 0 )
+#elif DEBUG_TRACE == 1
+#define MMTRACE( fmt, ... ) mcu.MMprint ( fmt, ##__VA_ARGS__ )
+#else
+#define MMTRACE( fmt, ... ) do { } while ( 0 )
+#endif
+
+#endif
@@ -0,0 +1,54 @@
+/*
+ __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Vector table relocated in SRAM2.
+
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#include "McuVector.h"
+#include "McuSections.h"
+
+#if ( VECTOR_NUMBER * 4 ) > VECTOR_ALIGNMENT
+    #error "VECTOR_ALIGNMENT have to be the vector table size rounded up to a power of 2"
+#endif
+
+MCU_SRAM2_BSS static uint32_t VectorTable [ VECTOR_NUMBER ] __attribute__ ( ( aligned ( VECTOR_ALIGNMENT ) ) );
+
+void McuVectorInit ( void ) {
+#if RAM_VECTOR_ENABLE == 1
+    // the current table, in the flash bank the mcu booted from
+    const uint32_t * source = ( const uint32_t * ) SCB->VTOR;
+    if ( source == VectorTable ) {
+        return;
+    }
+    // PRIMASK rather than McuEnterCritical : the BASEPRI mask leaves the faults and the watchdog interrupt running
+    uint32_t primask = __get_PRIMASK ( );
+    __disable_irq ( );
+    for ( int i = 0; i < VECTOR_NUMBER; i++ ) {
+        VectorTable [ i ] = source [ i ];
+    }
+    __DSB ( );
+    SCB->VTOR = ( uint32_t ) VectorTable;
+    __DSB ( );
+    __ISB ( );
+    __set_PRIMASK ( primask );
+#endif
+}
+
+int McuVectorSet ( IRQn_Type irq, void ( * handler ) ( void ) ) {
+    if ( SCB->VTOR != ( uint32_t ) VectorTable ) {
+        return ( -1 );
+    }
+    VectorTable [ 16 + irq ] = ( uint32_t ) handler;
+    __DSB ( );
+    return ( 0 );
+}
@@ -0,0 +1,46 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Vector table relocated in SRAM2.
+                    The exception entry fetches the vector on the I-Code/D-Code bus while the context is
+                    stacked in SRAM1 : no flash wait state, no accelerator miss on the interrupt entry.
+                    The table also allows a handler to be replaced at run time with McuVectorSet.
+                    With RAM_VECTOR_ENABLE = 0 (UserDefine.h) the table stays in flash.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_VECTOR_H
+#define MCU_VECTOR_H
+#include "stdint.h"
+#include "UserDefine.h"
+#include "stm32l4xx_hal.h"
+
+#define VECTOR_NUMBER    ( 16 + FPU_IRQn + 1 )  // system exceptions and the last STM32L476 interrupt
+#define VECTOR_ALIGNMENT 512                    // VTOR alignment : table size rounded up to a power of 2
+
+/*!
+ * McuVectorInit : copy the current vector table in SRAM2 and point VTOR to it
+ * \remark called first in InitMcu, before HAL_Init starts the SysTick : no handler is replaced yet.
+ *         The copy and the VTOR switch run with PRIMASK set, calling it again does nothing
+ */
+void McuVectorInit ( void );
+
+/*!
+ * McuVectorSet : replace the handler of an interrupt
+ * \remark the table has to be relocated, the interrupt should be disabled while it is changed
+ * \param [IN]  irq      interrupt number, negative for the system exceptions
+ * \param [IN]  handler  new handler
+ * \param [OUT] return   0 if done, -1 if the table is still in flash
+ */
+int  McuVectorSet  ( IRQn_Type irq, void ( * handler ) ( void ) );
+
+#endif
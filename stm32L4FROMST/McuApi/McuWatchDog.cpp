@@ -0,0 +1,160 @@
+/*
+ __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Independent watchdog supervisor.
+
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#include "McuWatchDog.h"
+#include "ApiMcu.h"
+#include "McuLog.h"
+#include "McuSections.h"
+#include "McuHal.h"
+#if defined ( MCU_STM32L0 )
+    static IWDG_HandleTypeDef hiwdg;
+#else
+    #include "iwdg.h"
+    #define WatchDogIwdgInit( )  MX_IWDG_Init ( )
+#endif
+
+#define WATCH_DOG_LATE_MAGIC 0x1AD0A000U // | task id, kept in SRAM2 to be reported after the reset (STM32L4)
+
+typedef struct {
+    const char *      Name;
+    uint32_t          Timeout;
+    volatile uint32_t CheckIns;   // incremented by the task, may be in an ISR
+    uint32_t          Sampled;    // CheckIns value seen by the last McuWatchDogRelease
+    uint32_t          LastSeen;   // rtc time in seconds of the last CheckIns change
+    volatile uint8_t  Thread;     // last check in from thread mode : the task can not run while GotoSleepSecond sleeps
+} WatchDogTask_t;
+
+static WatchDogTask_t WatchDogTasks [ WATCH_DOG_MAX_TASKS ];
+static int            WatchDogTaskNumber = 0;
+static int            WatchDogStarted = 0;
+static int            WatchDogReported = -1;
+static int            WatchDogSleeping = 0;
+MCU_SRAM2_NOINIT static uint32_t WatchDogLate;
+
+#if defined ( MCU_STM32L0 )
+static void WatchDogIwdgInit ( void ) {
+    hiwdg.Instance       = IWDG;
+    hiwdg.Init.Prescaler = IWDG_PRESCALER_256;
+    hiwdg.Init.Window    = IWDG_WINDOW_DISABLE;
+    hiwdg.Init.Reload    = 0xFFF;
+    if ( HAL_IWDG_Init ( &hiwdg ) != HAL_OK ) {
+        MMLOG_ERROR ( MCU, "IWDG initialization failed\n" );
+    }
+}
+
+static void WatchDogCheckOptionBytes ( void ) {
+    // no IWDG_STOP option on this family : the IWDG always runs in Stop mode
+}
+#else
+static void WatchDogCheckOptionBytes ( void ) {
+    // factory default : the IWDG runs in Stop modes, a cleared IWDG_STOP bit would let a hang in Stop go unnoticed
+    if ( ( FLASH->OPTR & FLASH_OPTR_IWDG_STOP ) != 0 ) {
+        return;
+    }
+    FLASH_OBProgramInitTypeDef ob;
+    MMLOG_WARN ( MCU, "IWDG frozen in Stop mode, option bytes reprogrammed, the mcu resets\n" );
+    mcu.TraceFlush ( );
+    ob.OptionType = OPTIONBYTE_USER;
+    ob.USERType   = OB_USER_IWDG_STOP;
+    ob.USERConfig = OB_IWDG_STOP_RUN;
+    HAL_FLASH_Unlock ( );
+    HAL_FLASH_OB_Unlock ( );
+    if ( HAL_FLASHEx_OBProgram ( &ob ) == HAL_OK ) {
+        HAL_FLASH_OB_Launch ( ); // reloads the option bytes and resets the mcu
+    }
+    HAL_FLASH_OB_Lock ( );
+    HAL_FLASH_Lock ( );
+    MMLOG_ERROR ( MCU, "IWDG option bytes programming failed\n" );
+}
+#endif
+
+void McuWatchDogStart ( void ) {
+    if ( __HAL_RCC_GET_FLAG ( RCC_FLAG_IWDGRST ) != 0 ) {
+        if ( ( WatchDogLate & 0xFFFFFF00U ) == WATCH_DOG_LATE_MAGIC ) {
+            MMLOG_ERROR ( MCU, "reset by the watchdog, task %d was late\n", ( int ) ( WatchDogLate & 0xFF ) );
+        } else {
+            MMLOG_ERROR ( MCU, "reset by the watchdog\n" );
+        }
+        __HAL_RCC_CLEAR_RESET_FLAGS ( );
+    }
+    WatchDogLate = 0;
+    WatchDogCheckOptionBytes ( );
+    __HAL_DBGMCU_FREEZE_IWDG ( );
+    WatchDogIwdgInit ( );
+    WatchDogStarted = 1;
+}
+
+int McuWatchDogRegister ( const char * name, uint32_t timeoutSecond ) {
+    if ( WatchDogTaskNumber >= WATCH_DOG_MAX_TASKS ) {
+        return ( -1 );
+    }
+    WatchDogTask_t * task = &WatchDogTasks [ WatchDogTaskNumber ];
+    task->Name     = name;
+    task->Timeout  = timeoutSecond;
+    task->CheckIns = 0;
+    task->Sampled  = 0;
+    task->LastSeen = mcu.RtcGetTimeSecond ( );
+    task->Thread   = 1;
+    return ( WatchDogTaskNumber++ );
+}
+
+void McuWatchDogCheckIn ( int id ) {
+    if ( ( id >= 0 ) && ( id < WatchDogTaskNumber ) ) {
+        WatchDogTasks [ id ].CheckIns++;
+        WatchDogTasks [ id ].Thread = ( __get_IPSR ( ) == 0 ) ? 1 : 0;
+    }
+}
+
+int McuWatchDogRelease ( void ) {
+    if ( WatchDogStarted == 0 ) {
+        return ( -1 );
+    }
+    int      late = -1;
+    uint32_t now = ( WatchDogTaskNumber > 0 ) ? mcu.RtcGetTimeSecond ( ) : 0;
+    for ( int i = 0; i < WatchDogTaskNumber; i++ ) {
+        WatchDogTask_t * task = &WatchDogTasks [ i ];
+        uint32_t checkIns = task->CheckIns;
+        // the deadline of a thread task is suspended while GotoSleepSecond sleeps
+        if ( ( checkIns != task->Sampled ) || ( ( WatchDogSleeping != 0 ) && ( task->Thread != 0 ) ) ) {
+            task->Sampled  = checkIns;
+            task->LastSeen = now;
+        } else if ( ( late < 0 ) && ( ( now - task->LastSeen ) > task->Timeout ) ) {
+            late = i;
+        }
+    }
+    if ( late < 0 ) {
+        HAL_IWDG_Refresh ( &hiwdg );
+        WatchDogReported = -1;
+    } else if ( late != WatchDogReported ) {
+        WatchDogReported = late;
+        WatchDogLate = WATCH_DOG_LATE_MAGIC | ( uint32_t ) late;
+        MMLOG_ERROR ( MCU, "watchdog task %d late, no more refresh\n", late );
+    }
+    return ( late );
+}
+
+void McuWatchDogSleep ( int sleeping ) {
+    WatchDogSleeping = sleeping;
+}
+
+void McuWatchDogPrint ( void ) {
+    uint32_t now = mcu.RtcGetTimeSecond ( );
+    mcu.MMprint ( "iwdg %s\n", ( WatchDogStarted != 0 ) ? "running" : "stopped" );
+    for ( int i = 0; i < WatchDogTaskNumber; i++ ) {
+        mcu.MMprint ( "%d %-8s last check in %lu s ago, timeout %lu s\n", i, WatchDogTasks [ i ].Name,
+                      ( unsigned long ) ( now - WatchDogTasks [ i ].LastSeen ), ( unsigned long ) WatchDogTasks [ i ].Timeout );
+    }
+}
@@ -0,0 +1,75 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Independent watchdog supervisor.
+                    Each supervised task registers with its own timeout and checks in periodically.
+                    The IWDG is only refreshed when every task has checked in within its timeout :
+                    a hung task resets the mcu even if the main loop still calls WatchDogRelease.
+                    The IWDG runs from the LSI and keeps counting in Stop modes.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_WATCHDOG_H
+#define MCU_WATCHDOG_H
+#include "stdint.h"
+
+#define WATCH_DOG_MAX_TASKS      8
+#if defined ( MCU_STM32L0 )
+    #define WATCH_DOG_PERIOD_RELEASE 15 // LSI of 26 to 56 kHz : the Watch Dog period is 18 to 40 seconds
+#else
+    #define WATCH_DOG_PERIOD_RELEASE 30 // this period have to be lower than the Watch Dog period of 32 seconds
+#endif
+
+/*!
+ * McuWatchDogStart : start the IWDG, LSI / 256 and reload 0xFFF, about 32 seconds on the STM32L4, 28 on the STM32L0
+ * \remark the IWDG is frozen while the core is halted by a debugger
+ * \remark STM32L4 : if the IWDG_STOP option bit freezes the IWDG in Stop modes, it is reprogrammed : the mcu resets
+ */
+void         McuWatchDogStart      ( void );
+
+/*!
+ * McuWatchDogRegister : add a supervised task
+ * \remark the task is alive at registration
+ * \remark the timeout of a task checked in from thread mode is suspended during GotoSleepSecond, see McuWatchDogSleep
+ * \param [IN]  const char * name           not copied
+ * \param [IN]  uint32_t     timeoutSecond  maximum delay between two check in
+ * \param [OUT] int task id, -1 if the task table is full
+ */
+int          McuWatchDogRegister   ( const char * name, uint32_t timeoutSecond );
+
+/*!
+ * McuWatchDogCheckIn : the task is alive
+ * \remark callable from thread and ISR context
+ */
+void         McuWatchDogCheckIn    ( int id );
+
+/*!
+ * McuWatchDogRelease : refresh the IWDG if all the registered tasks are alive
+ * \param [OUT] int -1 if all tasks are alive, the id of the first late task otherwise
+ */
+int          McuWatchDogRelease    ( void );
+
+/*!
+ * McuWatchDogSleep : suspend the timeout of the tasks last checked in from thread mode
+ * \remark called by GotoSleepSecond around its sleep : these tasks can not run before it returns,
+ *         each WatchDogRelease made while sleeping counts as their check in.
+ *         The tasks checked in from an ISR stay supervised.
+ * \param [IN]  int sleeping  1 when entering the sleep, 0 when leaving it
+ */
+void         McuWatchDogSleep      ( int sleeping );
+
+/*!
+ * McuWatchDogPrint : print the tasks and the delay since their last check in
+ */
+void         McuWatchDogPrint      ( void );
+
+#endif
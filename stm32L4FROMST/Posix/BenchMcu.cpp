@@ -0,0 +1,188 @@
+/*
+ __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Benchmarks of the flash, time, log and gpio layers of the Mcu api.
+
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#include "McuBench.h"
+#include "ApiMcu.h"
+#include "UserDefine.h"
+#include "McuCrc.h"
+#include "McuLog.h"
+#include "McuPool.h"
+
+#define BENCH_CONTEXT_SIZE 64   // bytes of a LoRaWAN context
+
+static uint8_t BenchBuffer [ 2048 ];
+
+static void BenchFill ( uint32_t seed ) {
+    for ( uint32_t i = 0; i < sizeof ( BenchBuffer ); i++ ) {
+        BenchBuffer [ i ] = ( uint8_t ) ( i * 31 + seed );
+    }
+}
+
+/******************************************************************************/
+/*                                   Flash                                    */
+/******************************************************************************/
+static void BenchStoreContext64 ( McuBenchState & state ) {
+    BenchFill ( 1 );
+    while ( state.KeepRunning ( ) ) {
+        mcu.StoreContext ( BenchBuffer, USERFLASHADRESS, BENCH_CONTEXT_SIZE / 8 );
+    }
+    state.SetBytesProcessed ( state.Iterations ( ) * BENCH_CONTEXT_SIZE );
+}
+MMBENCH ( BenchStoreContext64 );
+
+static void BenchStoreContext2048 ( McuBenchState & state ) {
+    BenchFill ( 2 );
+    while ( state.KeepRunning ( ) ) {
+        mcu.StoreContext ( BenchBuffer, USERFLASHADRESS, sizeof ( BenchBuffer ) / 8 );
+    }
+    state.SetBytesProcessed ( state.Iterations ( ) * sizeof ( BenchBuffer ) );
+}
+MMBENCH ( BenchStoreContext2048 );
+
+static void BenchRestoreContext64 ( McuBenchState & state ) {
+    uint8_t context [ BENCH_CONTEXT_SIZE ];
+    while ( state.KeepRunning ( ) ) {
+        mcu.RestoreContext ( context, USERFLASHADRESS, sizeof ( context ) );
+        McuBenchDoNotOptimize ( context [ 0 ] );
+    }
+    state.SetBytesProcessed ( state.Iterations ( ) * BENCH_CONTEXT_SIZE );
+}
+MMBENCH ( BenchRestoreContext64 );
+
+static void BenchWriteWithoutErase16 ( McuBenchState & state ) {
+    BenchFill ( 3 );
+    while ( state.KeepRunning ( ) ) {
+        mcu.WriteFlashWithoutErase ( BenchBuffer, USERFLASHADRESS + 8, 16 );
+    }
+    state.SetBytesProcessed ( state.Iterations ( ) * 16 );
+}
+MMBENCH ( BenchWriteWithoutErase16 );
+
+/* store, read back and check the crc like a context kept across resets */
+static void BenchContextCheck64 ( McuBenchState & state ) {
+    uint8_t context [ BENCH_CONTEXT_SIZE ];
+    BenchFill ( 4 );
+    uint32_t crc = McuCrc32 ( BenchBuffer, BENCH_CONTEXT_SIZE - 4 );
+    memcpy ( &BenchBuffer [ BENCH_CONTEXT_SIZE - 4 ], &crc, 4 );
+    while ( state.KeepRunning ( ) ) {
+        mcu.StoreContext ( BenchBuffer, USERFLASHADRESS, BENCH_CONTEXT_SIZE / 8 );
+        mcu.RestoreContext ( context, USERFLASHADRESS, sizeof ( context ) );
+        McuBenchDoNotOptimize ( McuCrc32 ( context, BENCH_CONTEXT_SIZE - 4 ) == crc );
+    }
+    state.SetBytesProcessed ( state.Iterations ( ) * BENCH_CONTEXT_SIZE );
+}
+MMBENCH ( BenchContextCheck64 );
+
+/******************************************************************************/
+/*                              Integrity, memory                             */
+/******************************************************************************/
+static void BenchCrc32_64 ( McuBenchState & state ) {
+    BenchFill ( 5 );
+    while ( state.KeepRunning ( ) ) {
+        McuBenchDoNotOptimize ( McuCrc32 ( BenchBuffer, 64 ) );
+    }
+    state.SetBytesProcessed ( state.Iterations ( ) * 64 );
+}
+MMBENCH ( BenchCrc32_64 );
+
+static void BenchCrc32_2048 ( McuBenchState & state ) {
+    BenchFill ( 6 );
+    while ( state.KeepRunning ( ) ) {
+        McuBenchDoNotOptimize ( McuCrc32 ( BenchBuffer, sizeof ( BenchBuffer ) ) );
+    }
+    state.SetBytesProcessed ( state.Iterations ( ) * sizeof ( BenchBuffer ) );
+}
+MMBENCH ( BenchCrc32_2048 );
+
+static void BenchPoolAllocFree ( McuBenchState & state ) {
+    while ( state.KeepRunning ( ) ) {
+        void * small = McuPoolAlloc ( 48 );
+        void * line  = McuPoolAlloc ( 200 );
+        McuBenchDoNotOptimize ( line );
+        McuPoolFree ( line );
+        McuPoolFree ( small );
+    }
+}
+MMBENCH ( BenchPoolAllocFree );
+
+/******************************************************************************/
+/*                                    Time                                    */
+/******************************************************************************/
+static void BenchRtcGetTimeMs ( McuBenchState & state ) {
+    while ( state.KeepRunning ( ) ) {
+        McuBenchDoNotOptimize ( mcu.RtcGetTimeMs ( ) );
+    }
+}
+MMBENCH ( BenchRtcGetTimeMs );
+
+static void BenchTimerIrq ( void * ) {
+}
+
+static void BenchTimerStart ( McuBenchState & state ) {
+    int delay = 1;
+    while ( state.KeepRunning ( ) ) {
+        // ms to LPTIM ticks conversion and arming, restarted before it fires
+        mcu.StartTimerMsecond ( BenchTimerIrq, NULL, 1000 + delay );
+        delay = ( delay + 7 ) & 0x3FFF;
+    }
+    mcu.LowPowerTimerLoRaInit ( );
+}
+MMBENCH ( BenchTimerStart );
+
+/******************************************************************************/
+/*                                    Logs                                    */
+/******************************************************************************/
+static void BenchUartDiscard ( const uint8_t * data, uint32_t length ) {
+    McuBenchDoNotOptimize ( data [ 0 ] );
+}
+
+static void BenchLogFormat ( McuBenchState & state ) {
+    int counter = 0;
+    mcu.SetUartHook ( BenchUartDiscard );
+    McuLogSetLevel ( LOG_MODULE_MCU, LOG_LEVEL_INFO );
+    while ( state.KeepRunning ( ) ) {
+        MMLOG_INFO ( MCU, "rx window %d at %lu ms, rssi %d snr %d\n", counter++, ( unsigned long ) 123456, -97, 7 );
+    }
+    mcu.SetUartHook ( NULL );
+}
+MMBENCH ( BenchLogFormat );
+
+static void BenchLogFiltered ( McuBenchState & state ) {
+    int counter = 0;
+    mcu.SetUartHook ( BenchUartDiscard );
+    McuLogSetLevel ( LOG_MODULE_MCU, LOG_LEVEL_WARN );
+    while ( state.KeepRunning ( ) ) {
+        MMLOG_INFO ( MCU, "rx window %d at %lu ms, rssi %d snr %d\n", counter++, ( unsigned long ) 123456, -97, 7 );
+    }
+    McuLogSetLevel ( LOG_MODULE_MCU, LOG_LEVEL_MCU );
+    mcu.SetUartHook ( NULL );
+}
+MMBENCH ( BenchLogFiltered );
+
+/******************************************************************************/
+/*                                    Gpio                                    */
+/******************************************************************************/
+static void BenchGpioWriteRead ( McuBenchState & state ) {
+    static const PinName pins [ ] = { LORA_CS, LORA_RESET, PB_5, PC_7, PA_9, PC_13 };
+    int value = 0;
+    while ( state.KeepRunning ( ) ) {
+        for ( uint32_t i = 0; i < sizeof ( pins ) / sizeof ( pins [ 0 ] ); i++ ) {
+            mcu.SetValueDigitalOutPin ( pins [ i ], value );
+            value ^= mcu.GetValueDigitalInPin ( pins [ i ] ) ^ 1;
+        }
+    }
+}
+MMBENCH ( BenchGpioWriteRead );
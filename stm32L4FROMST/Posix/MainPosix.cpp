@@ -0,0 +1,126 @@
+/*
+ __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Host simulation entry point (make posix).
+                    Runs the Mcu layer on McuPosix for the virtual duration given in seconds on the
+                    command line, a week by default : every SIM_APP_PERIOD_S an uplink like cycle
+                    with its two receive windows on the LPTIM timer, a sensor read by a McuTask, the flash context store every
+                    FLASH_UPDATE_PERIOD cycles and a sleep until the next one. Prints the virtual and
+                    the host time spent and the simulator report.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#include "ApiMcu.h"
+#include "UserDefine.h"
+#include "McuLog.h"
+#include "McuWatchDog.h"
+#include "McuProfile.h"
+#include "McuEvent.h"
+#include "McuTask.h"
+#include <stdlib.h>
+#include <chrono>
+
+#define SIM_APP_PERIOD_S   60
+#define SIM_RX1_DELAY_MS   1000
+#define SIM_RX2_DELAY_MS   1000   // after RX1
+#define SIM_RX_DURATION_MS 3000   // the windows run during this part of the cycle
+#define SIM_SENSOR_WARMUP_MS 200
+#define SIM_SENSOR_POWER   PB_5
+#define SIM_SENSOR_START   TASK_SIGNAL_USER ( 0 )
+
+McuXX<McuPosix> mcu ( LORA_SPI_MOSI, LORA_SPI_MISO, LORA_SPI_SCLK ) ;
+
+static volatile uint32_t RxWindowNumber = 0;
+static uint32_t          SensorReadNumber = 0;
+static McuTask_t         SensorTask;
+
+static void SimRx2 ( void * ) {
+    RxWindowNumber = RxWindowNumber + 1;
+}
+
+static void SimRx1 ( void * ) {
+    RxWindowNumber = RxWindowNumber + 1;
+    mcu.StartTimerMsecond ( SimRx2, NULL, SIM_RX2_DELAY_MS );
+}
+
+/* a sensor read as a task : power, warm up, read, power off, one read per cycle */
+static int SimSensorSequence ( McuTask_t * task ) {
+    MMTASK_BEGIN ( task );
+    for ( ;; ) {
+        MMTASK_WAIT_SIGNAL ( task, SIM_SENSOR_START );
+        mcu.SetValueDigitalOutPin ( SIM_SENSOR_POWER, 1 );
+        MMTASK_SLEEP_MS ( task, SIM_SENSOR_WARMUP_MS );
+        SensorReadNumber++;
+        mcu.SetValueDigitalOutPin ( SIM_SENSOR_POWER, 0 );
+    }
+    MMTASK_END ( task );
+}
+
+/* the main loop of the target : the timer callbacks run from McuEventDispatch with EVENT_LOOP_ENABLE */
+static void SimRunEvents ( uint32_t durationMs ) {
+    uint64_t end = McuPosixNowUs ( ) + ( uint64_t ) durationMs * 1000;
+    while ( McuPosixNowUs ( ) < end ) {
+        if ( McuEventDispatch ( ) + McuTaskRun ( ) == 0 ) {
+            // the SysTick wakes the target every ms, here the idle ends at the next task deadline
+            uint64_t idleUs = end - McuPosixNowUs ( );
+            uint64_t taskUs = ( uint64_t ) McuTaskNextWakeMs ( ) * 1000;
+            McuPosixIdle ( ( taskUs < idleUs ) ? taskUs : idleUs );
+        }
+    }
+    mcu.WatchDogRelease ( );
+}
+
+int main ( int argc, char ** argv ) {
+    uint32_t durationSecond = ( argc > 1 ) ? ( uint32_t ) atoi ( argv [ 1 ] ) : 7 * 24 * 3600;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ( );
+    mcu.InitMcu ( );
+    mcu.LowPowerTimerLoRaInit ( );
+    mcu.WatchDogStart ( );
+    // the main loop sleeps almost SIM_APP_PERIOD_S between two check in, its timeout is suspended meanwhile
+    int mainLoopTask = mcu.WatchDogRegister ( "main", WATCH_DOG_PERIOD_RELEASE );
+    McuTaskStart ( &SensorTask, "sensor", SimSensorSequence, NULL );
+
+    uint8_t context [ 64 ];
+    uint8_t restored [ 64 ];
+    for ( uint32_t i = 0; i < sizeof ( context ); i++ ) {
+        context [ i ] = ( uint8_t ) i;
+    }
+    if ( ( mcu.StoreContext ( context, USERFLASHADRESS, sizeof ( context ) / 8 ) != 0 )
+      || ( mcu.RestoreContext ( restored, USERFLASHADRESS, sizeof ( restored ) ) != 0 )
+      || ( memcmp ( context, restored, sizeof ( context ) ) != 0 ) ) {
+        MMLOG_ERROR ( FLASH, "context store failure \n" );
+        return ( 1 );
+    }
+
+    uint32_t cycles = 0;
+    while ( mcu.RtcGetTimeSecond ( ) < durationSecond ) {
+        mcu.StartTimerMsecond ( SimRx1, NULL, SIM_RX1_DELAY_MS );
+        McuTaskSignal ( SIM_SENSOR_START );
+        SimRunEvents ( SIM_RX_DURATION_MS );
+        if ( ( ++cycles % FLASH_UPDATE_PERIOD ) == 0 ) {
+            mcu.StoreContext ( context, USERFLASHADRESS, sizeof ( context ) / 8 );
+        }
+        mcu.WatchDogCheckIn ( mainLoopTask );
+        mcu.GotoSleepSecond ( SIM_APP_PERIOD_S - SIM_RX_DURATION_MS / 1000 );
+        mcu.WatchDogRelease ( );
+        mcu.TraceFlush ( );
+    }
+
+    double hostSecond = std::chrono::duration < double > ( std::chrono::steady_clock::now ( ) - start ).count ( );
+    mcu.MMprint ( "%lu virtual s in %.3f host s, %lu cycles, %lu rx windows, %lu sensor reads \n", ( unsigned long ) durationSecond,
+                  hostSecond, ( unsigned long ) cycles, ( unsigned long ) RxWindowNumber, ( unsigned long ) SensorReadNumber );
+    McuTaskPrint ( );
+    McuPosixPrint ( );
+#if PROFILE_ENABLE == 1
+    McuProfilePrint ( );
+#endif
+    return ( 0 );
+}
@@ -0,0 +1,104 @@
+/*
+ __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Host micro benchmark runner.
+                    posix-bench [filter] [--csv] : runs the benchmarks whose name holds filter,
+                    --csv prints one line per benchmark for a regression script.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#include "McuBench.h"
+#include "ApiMcu.h"
+#include "UserDefine.h"
+#include <stdlib.h>
+#include <chrono>
+
+typedef struct {
+    const char *   Name;
+    McuBenchFunc_t Func;
+} McuBench_t;
+
+static McuBench_t BenchTable [ BENCH_MAX_NUMBER ];
+static int        BenchNumber = 0;
+
+McuXX<McuPosix> mcu ( LORA_SPI_MOSI, LORA_SPI_MISO, LORA_SPI_SCLK ) ;
+
+int McuBenchRegister ( const char * name, McuBenchFunc_t func ) {
+    if ( BenchNumber >= BENCH_MAX_NUMBER ) {
+        fprintf ( stderr, "BENCH_MAX_NUMBER reached, %s is not registered\n", name );
+        return ( -1 );
+    }
+    BenchTable [ BenchNumber ].Name = name;
+    BenchTable [ BenchNumber ].Func = func;
+    return ( BenchNumber++ );
+}
+
+/* one run of iterations, in ns */
+static double BenchRun ( McuBenchFunc_t func, McuBenchState & state ) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ( );
+    func ( state );
+    return ( std::chrono::duration < double, std::nano > ( std::chrono::steady_clock::now ( ) - start ).count ( ) );
+}
+
+int main ( int argc, char ** argv ) {
+    const char * filter = NULL;
+    int csv = 0;
+    for ( int i = 1; i < argc; i++ ) {
+        if ( strcmp ( argv [ i ], "--csv" ) == 0 ) {
+            csv = 1;
+        } else {
+            filter = argv [ i ];
+        }
+    }
+    setenv ( "MCU_POSIX_FLASH", "", 0 ); // the flash image stays in memory unless asked for
+    mcu.InitMcu ( );
+    mcu.LowPowerTimerLoRaInit ( );
+
+    if ( csv != 0 ) {
+        printf ( "name,iterations,ns_per_op,ops_per_s,bytes_per_s,programmed_per_op,erased_per_op\n" );
+    } else {
+        printf ( "%-28s %12s %12s %14s %12s %12s %12s\n", "benchmark", "iterations", "ns/op", "ops/s", "MB/s", "prog B/op", "erase B/op" );
+    }
+    for ( int b = 0; b < BenchNumber; b++ ) {
+        if ( ( filter != NULL ) && ( strstr ( BenchTable [ b ].Name, filter ) == NULL ) ) {
+            continue;
+        }
+        uint64_t iterations = 1;
+        double   ns;
+        uint64_t programmed, erased, bytes;
+        for ( ;; ) {
+            McuBenchState state ( iterations );
+            McuPosixResetStats ( );
+            ns = BenchRun ( BenchTable [ b ].Func, state );
+            McuPosixFlashCounters ( &programmed, &erased );
+            bytes = state.BytesProcessed ( );
+            if ( ( ns >= BENCH_MIN_TIME_MS * 1e6 ) || ( iterations >= ( 1ULL << 40 ) ) ) {
+                break;
+            }
+            // aim at 1.5 times the minimum time from this run, at least twice more iterations
+            double next = ( ns > 0 ) ? iterations * ( BENCH_MIN_TIME_MS * 1.5e6 ) / ns : iterations * 10.0;
+            iterations = ( next > 2.0 * iterations ) ? ( uint64_t ) next : 2 * iterations;
+        }
+        double nsPerOp  = ns / iterations;
+        double opsPerS  = 1e9 / nsPerOp;
+        double mbPerS   = ( bytes * 1e3 ) / ns;
+        double progPerOp  = ( double ) programmed / iterations;
+        double erasePerOp = ( double ) erased / iterations;
+        if ( csv != 0 ) {
+            printf ( "%s,%llu,%.2f,%.0f,%.0f,%.1f,%.1f\n", BenchTable [ b ].Name, ( unsigned long long ) iterations, nsPerOp, opsPerS,
+                     mbPerS * 1e6, progPerOp, erasePerOp );
+        } else {
+            printf ( "%-28s %12llu %12.1f %14.0f %12.2f %12.1f %12.1f\n", BenchTable [ b ].Name, ( unsigned long long ) iterations,
+                     nsPerOp, opsPerS, mbPerS, progPerOp, erasePerOp );
+        }
+    }
+    return ( 0 );
+}
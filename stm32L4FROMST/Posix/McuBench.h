@@ -0,0 +1,62 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Host micro benchmarks of the Mcu layer on McuPosix (make posix-bench).
+                    A benchmark is a function looping on KeepRunning, registered with MMBENCH :
+                        static void BenchCrc32 ( McuBenchState & state ) {
+                            while ( state.KeepRunning ( ) ) { ... }
+                            state.SetBytesProcessed ( state.Iterations ( ) * 64 );
+                        }
+                        MMBENCH ( BenchCrc32 );
+                    The runner doubles the iterations until a run lasts BENCH_MIN_TIME_MS, then prints
+                    ns/op, ops/s, the bytes processed per second and the flash bytes programmed and
+                    erased per operation, counted by McuPosix.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef MCU_BENCH_H
+#define MCU_BENCH_H
+#include "stdint.h"
+
+#define BENCH_MIN_TIME_MS 200
+#define BENCH_MAX_NUMBER  32
+
+class McuBenchState {
+public :
+    explicit McuBenchState ( uint64_t iterations ) : Remaining ( iterations ), Total ( iterations ), Bytes ( 0 ) { };
+    bool     KeepRunning       ( void ) { return ( Remaining-- != 0 ); };
+    uint64_t Iterations        ( void ) const { return ( Total ); };
+    void     SetBytesProcessed ( uint64_t bytes ) { Bytes = bytes; };
+    uint64_t BytesProcessed    ( void ) const { return ( Bytes ); };
+private :
+    uint64_t Remaining;
+    uint64_t Total;
+    uint64_t Bytes;
+};
+
+typedef void ( * McuBenchFunc_t ) ( McuBenchState & state );
+
+/*!
+ * McuBenchRegister : add a benchmark, through MMBENCH
+ */
+int McuBenchRegister ( const char * name, McuBenchFunc_t func );
+
+/*!
+ * McuBenchDoNotOptimize : keep a result the compiler would drop otherwise
+ */
+template < typename T > inline void McuBenchDoNotOptimize ( const T & value ) {
+    __asm__ volatile ( "" : : "r,m" ( value ) : "memory" );
+}
+
+#define MMBENCH( func ) static int func##Registered __attribute__ ( ( unused ) ) = McuBenchRegister ( #func, func )
+
+#endif
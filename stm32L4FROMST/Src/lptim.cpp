@@ -41,7 +41,7 @@
 #include "lptim.h"
 
 /* USER CODE BEGIN 0 */
-
+#include "McuPriority.h"
 /* USER CODE END 0 */
 
 LPTIM_HandleTypeDef hlptim1;
@@ -78,7 +78,7 @@ void HAL_LPTIM_MspInit(LPTIM_HandleTypeDef* lptimHandle)
     __HAL_RCC_LPTIM1_CLK_ENABLE();
 
     /* LPTIM1 interrupt Init */
-    HAL_NVIC_SetPriority(LPTIM1_IRQn, 0, 0);
+    HAL_NVIC_SetPriority(LPTIM1_IRQn, NVIC_PRIORITY_TIMER, 0);
     HAL_NVIC_EnableIRQ(LPTIM1_IRQn);
   /* USER CODE BEGIN LPTIM1_MspInit 1 */
 
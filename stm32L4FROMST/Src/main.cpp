@@ -50,6 +50,10 @@
 #include "UserDefine.h"
 #include "ApiMcu.h"
 /* USER CODE BEGIN Includes */
+#include "McuWatchDog.h"
+#include "McuEvent.h"
+#include "McuTask.h"
+#include "McuPriority.h"
 
 /* USER CODE END Includes */
 
@@ -57,6 +61,7 @@
 
 /* USER CODE BEGIN PV */
 /* Private variables ---------------------------------------------------------*/
+static int MainLoopTask;
 
 /* USER CODE END PV */
 
@@ -86,31 +91,17 @@ int main(void)
 
   /* MCU Configuration----------------------------------------------------------*/
 
-  /* Reset of all peripherals, Initializes the Flash interface and the Systick. */
-  HAL_Init();
+  /* Vector table, HAL, clocks, peripherals, WWDG and the crash dump of the last reset : one sequence, McuSTM32L4::InitMcu */
+  mcu.InitMcu();
 
-  /* USER CODE BEGIN Init */
-
-  /* USER CODE END Init */
-
-  /* Configure the system clock */
-  SystemClock_Config();
-
-  /* USER CODE BEGIN SysInit */
-
-  /* USER CODE END SysInit */
-
-  /* Initialize all configured peripherals */
-  MX_GPIO_Init();
-  MX_LPTIM1_Init();
-  MX_USART2_UART_Init();
-  MX_SPI1_Init();
-  MX_RTC_Init();
+  /* Initialize the peripherals not used by the Mcu layer */
   MX_I2C1_Init();
 
-  //MX_IWDG_Init();
 
   /* USER CODE BEGIN 2 */
+  mcu.UartInit();
+  mcu.WatchDogStart();
+  MainLoopTask = mcu.WatchDogRegister("main", WATCH_DOG_PERIOD_RELEASE);
 
   /* USER CODE END 2 */
 
@@ -122,6 +113,18 @@ int main(void)
   /* USER CODE END WHILE */
 
   /* USER CODE BEGIN 3 */
+    mcu.ConsoleProcess();
+    mcu.TraceFlush();
+    mcu.WatchDogCheckIn(MainLoopTask);
+    mcu.WatchDogRelease();
+    mcu.EnergyUpdate();
+    int busy = McuTaskRun();
+#if EVENT_LOOP_ENABLE == 1
+    busy += McuEventDispatch();
+    if (busy == 0) {
+      McuEventIdle();
+    }
+#endif
 
   }
   /* USER CODE END 3 */
@@ -198,7 +201,7 @@ void SystemClock_Config(void)
   HAL_SYSTICK_CLKSourceConfig(SYSTICK_CLKSOURCE_HCLK);
 
   /* SysTick_IRQn interrupt configuration */
-  HAL_NVIC_SetPriority(SysTick_IRQn, 0, 0);
+  HAL_NVIC_SetPriority(SysTick_IRQn, NVIC_PRIORITY_SYSTICK, 0);
 }
 
 /* USER CODE BEGIN 4 */
@@ -41,7 +41,7 @@
 #include "rtc.h"
 
 /* USER CODE BEGIN 0 */
-
+#include "McuPriority.h"
 /* USER CODE END 0 */
 
 RTC_HandleTypeDef hrtc;
@@ -122,7 +122,7 @@ void HAL_RTC_MspInit(RTC_HandleTypeDef* rtcHandle)
     __HAL_RCC_RTC_ENABLE();
 
     /* RTC interrupt Init */
-    HAL_NVIC_SetPriority(RTC_WKUP_IRQn, 0, 0);
+    HAL_NVIC_SetPriority(RTC_WKUP_IRQn, NVIC_PRIORITY_RTC, 0);
     HAL_NVIC_EnableIRQ(RTC_WKUP_IRQn);
   /* USER CODE BEGIN RTC_MspInit 1 */
 
@@ -35,6 +35,10 @@
 #include "stm32l4xx.h"
 #include "stm32l4xx_it.h"
 #include "ApiMcu.h"
+#include "McuConsole.h"
+#include "UserDefine.h"
+#include "McuIsrStats.h"
+#include "McuSections.h"
 /* USER CODE BEGIN 0 */
 
 /* USER CODE END 0 */
@@ -43,6 +47,8 @@
 extern I2C_HandleTypeDef hi2c1;
 extern LPTIM_HandleTypeDef hlptim1;
 extern RTC_HandleTypeDef hrtc;
+extern DMA_HandleTypeDef hdma_usart2_rx;
+extern WWDG_HandleTypeDef hwwdg;
 
 /******************************************************************************/
 /*            Cortex-M4 Processor Interruption and Exception Handlers         */ 
@@ -61,6 +67,8 @@ void NMI_Handler(void)
   /* USER CODE END NonMaskableInt_IRQn 1 */
 }
 
+#if FAULT_DUMP_ENABLE == 0
+/* with FAULT_DUMP_ENABLE the fault handlers are aliases of McuFaultEntry (McuApi/McuFault.cpp) */
 /**
 * @brief This function handles Hard fault interrupt.
 */
@@ -132,6 +140,7 @@ void UsageFault_Handler(void)
 
   /* USER CODE END UsageFault_IRQn 1 */
 }
+#endif
 
 /**
 * @brief This function handles System service call via SWI instruction.
@@ -175,14 +184,19 @@ void PendSV_Handler(void)
 /**
 * @brief This function handles System tick timer.
 */
-void SysTick_Handler(void)
+MCU_RAMFUNC void SysTick_Handler(void)
 {
   /* USER CODE BEGIN SysTick_IRQn 0 */
-
+  MMISR_LATENCY(ISR_STAT_SYSTICK, McuIsrLatencySysTick());
   /* USER CODE END SysTick_IRQn 0 */
   HAL_IncTick();
   HAL_SYSTICK_IRQHandler();
   /* USER CODE BEGIN SysTick_IRQn 1 */
+#if WWDG_ENABLE == 1
+  if (hwwdg.Instance != NULL) {
+    HAL_WWDG_Refresh(&hwwdg);
+  }
+#endif
 
   /* USER CODE END SysTick_IRQn 1 */
 }
@@ -200,7 +214,7 @@ void SysTick_Handler(void)
 void RTC_WKUP_IRQHandler(void)
 {
   /* USER CODE BEGIN RTC_WKUP_IRQn 0 */
-
+  MMISR(ISR_STAT_RTC_WKUP);
   /* USER CODE END RTC_WKUP_IRQn 0 */
   HAL_RTCEx_WakeUpTimerIRQHandler(&hrtc);
   /* USER CODE BEGIN RTC_WKUP_IRQn 1 */
@@ -214,7 +228,7 @@ void RTC_WKUP_IRQHandler(void)
 void I2C1_EV_IRQHandler(void)
 {
   /* USER CODE BEGIN I2C1_EV_IRQn 0 */
-
+  MMISR(ISR_STAT_I2C1_EV);
   /* USER CODE END I2C1_EV_IRQn 0 */
   HAL_I2C_EV_IRQHandler(&hi2c1);
   /* USER CODE BEGIN I2C1_EV_IRQn 1 */
@@ -223,24 +237,36 @@ void I2C1_EV_IRQHandler(void)
 }
 
 /**
-* @brief This function handles EXTI line[15:10] interrupts.
+* @brief These functions handle the EXTI lines of Board::RadioIrq and Board::RxTimeoutIrq.
+*        Only the vectors of these two lines are enabled, by McuSTM32L4::Init_Irq.
 */
-void EXTI15_10_IRQHandler(void)
+MCU_RAMFUNC void EXTI0_IRQHandler(void)
 {
-  /* USER CODE BEGIN EXTI15_10_IRQn 0 */
-
-  /* USER CODE END EXTI15_10_IRQn 0 */
-    HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_10);
-    mcu.ExtISR();
-  /* USER CODE BEGIN EXTI15_10_IRQn 1 */
-
-  /* USER CODE END EXTI15_10_IRQn 1 */
+    IrqHandlerRadio();
 }
-void EXTI3_IRQHandler(void)
+MCU_RAMFUNC void EXTI1_IRQHandler(void)
 {
-
-    HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_3);
-    mcu.ExtISR();
+    IrqHandlerRadio();
+}
+MCU_RAMFUNC void EXTI2_IRQHandler(void)
+{
+    IrqHandlerRadio();
+}
+MCU_RAMFUNC void EXTI3_IRQHandler(void)
+{
+    IrqHandlerRadio();
+}
+MCU_RAMFUNC void EXTI4_IRQHandler(void)
+{
+    IrqHandlerRadio();
+}
+MCU_RAMFUNC void EXTI9_5_IRQHandler(void)
+{
+    IrqHandlerRadio();
+}
+MCU_RAMFUNC void EXTI15_10_IRQHandler(void)
+{
+    IrqHandlerRadio();
 }
 
 
@@ -248,10 +274,10 @@ void EXTI3_IRQHandler(void)
 /**
 * @brief This function handles LPTIM1 global interrupt.
 */
-void LPTIM1_IRQHandler(void)
+MCU_RAMFUNC void LPTIM1_IRQHandler(void)
 {
   /* USER CODE BEGIN LPTIM1_IRQn 0 */
-
+  MMISR_LATENCY(ISR_STAT_LPTIM1, McuIsrLatencyLptim1());
   /* USER CODE END LPTIM1_IRQn 0 */
     HAL_LPTIM_IRQHandler(&hlptim1);
   /* USER CODE BEGIN LPTIM1_IRQn 1 */
@@ -260,6 +286,34 @@ void LPTIM1_IRQHandler(void)
   /* USER CODE END LPTIM1_IRQn 1 */
 }
 
+/**
+* @brief This function handles DMA1 channel6 global interrupt (USART2_RX half and full transfer).
+*/
+void DMA1_Channel6_IRQHandler(void)
+{
+  /* USER CODE BEGIN DMA1_Channel6_IRQn 0 */
+  MMISR(ISR_STAT_DMA1_CH6);
+  /* USER CODE END DMA1_Channel6_IRQn 0 */
+  HAL_DMA_IRQHandler(&hdma_usart2_rx);
+  /* USER CODE BEGIN DMA1_Channel6_IRQn 1 */
+
+  /* USER CODE END DMA1_Channel6_IRQn 1 */
+}
+
+/**
+* @brief This function handles USART2 global interrupt (idle line and receive errors only).
+*/
+void USART2_IRQHandler(void)
+{
+  /* USER CODE BEGIN USART2_IRQn 0 */
+  MMISR(ISR_STAT_USART2);
+  /* USER CODE END USART2_IRQn 0 */
+    McuConsoleUartIrq();
+  /* USER CODE BEGIN USART2_IRQn 1 */
+
+  /* USER CODE END USART2_IRQn 1 */
+}
+
 /* USER CODE BEGIN 1 */
 
 /* USER CODE END 1 */
@@ -43,10 +43,12 @@
 #include "gpio.h"
 
 /* USER CODE BEGIN 0 */
-
+#include "UserDefine.h"
+#include "McuPriority.h"
 /* USER CODE END 0 */
 
 UART_HandleTypeDef huart2;
+DMA_HandleTypeDef hdma_usart2_rx;
 
 /* USART2 init function */
 
@@ -54,7 +56,7 @@ void MX_USART2_UART_Init(void)
 {
 
   huart2.Instance = USART2;
-  huart2.Init.BaudRate = 115200;
+  huart2.Init.BaudRate = UART_TRACE_BAUD;
   huart2.Init.WordLength = UART_WORDLENGTH_8B;
   huart2.Init.StopBits = UART_STOPBITS_1;
   huart2.Init.Parity = UART_PARITY_NONE;
@@ -94,7 +96,29 @@ void HAL_UART_MspInit(UART_HandleTypeDef* uartHandle)
     HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 
   /* USER CODE BEGIN USART2_MspInit 1 */
-
+#if CONSOLE_ENABLE == 1
+    /* USART2_RX DMA Init : circular, the console reads it on idle line */
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    hdma_usart2_rx.Instance = DMA1_Channel6;
+    hdma_usart2_rx.Init.Request = DMA_REQUEST_2;
+    hdma_usart2_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_usart2_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_usart2_rx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_usart2_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_usart2_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_usart2_rx.Init.Mode = DMA_CIRCULAR;
+    hdma_usart2_rx.Init.Priority = DMA_PRIORITY_LOW;
+    if (HAL_DMA_Init(&hdma_usart2_rx) != HAL_OK)
+    {
+      _Error_Handler( __LINE__);
+    }
+    __HAL_LINKDMA(uartHandle,hdmarx,hdma_usart2_rx);
+
+    HAL_NVIC_SetPriority(DMA1_Channel6_IRQn, NVIC_PRIORITY_CONSOLE, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel6_IRQn);
+    HAL_NVIC_SetPriority(USART2_IRQn, NVIC_PRIORITY_CONSOLE, 0);
+    HAL_NVIC_EnableIRQ(USART2_IRQn);
+#endif
   /* USER CODE END USART2_MspInit 1 */
   }
 }
@@ -117,13 +141,70 @@ void HAL_UART_MspDeInit(UART_HandleTypeDef* uartHandle)
     HAL_GPIO_DeInit(GPIOA, GPIO_PIN_2|GPIO_PIN_3);
 
   /* USER CODE BEGIN USART2_MspDeInit 1 */
+#if CONSOLE_ENABLE == 1
+    HAL_DMA_DeInit(uartHandle->hdmarx);
+    HAL_NVIC_DisableIRQ(DMA1_Channel6_IRQn);
+    HAL_NVIC_DisableIRQ(USART2_IRQn);
+#endif
 
   /* USER CODE END USART2_MspDeInit 1 */
   }
 } 
 
 /* USER CODE BEGIN 1 */
+/**
+  * @brief  Change the USART2 baud rate at runtime.
+  *         BRR is computed from the live PCLK1, 8x oversampling is selected above PCLK1/16
+  *         so that rates up to PCLK1/8 (8 Mbauds with PCLK1 = 64 MHz) are reachable.
+  *         The pending transmission is completed before the uart is disabled, the DMA
+  *         reception (if any) resumes with the new rate.
+  * @param  BaudRate: new rate in bauds, from PCLK1/65535 up to PCLK1/8
+  * @retval HAL_OK, HAL_ERROR if the rate is out of range or HAL_TIMEOUT
+  */
+HAL_StatusTypeDef MX_USART2_SetBaudRate(uint32_t BaudRate)
+{
+  uint32_t pclk = HAL_RCC_GetPCLK1Freq();
+  uint32_t oversampling;
+  uint32_t brr;
+  uint32_t tickstart;
 
+  if ((BaudRate == 0U) || (BaudRate > (pclk / 8U)))
+  {
+    return HAL_ERROR;
+  }
+  if (BaudRate > (pclk / 16U))
+  {
+    uint32_t usartdiv = ((2U * pclk) + (BaudRate / 2U)) / BaudRate;
+    brr = (usartdiv & 0xFFF0U) | ((usartdiv & 0x000FU) >> 1U);
+    oversampling = UART_OVERSAMPLING_8;
+  }
+  else
+  {
+    brr = (pclk + (BaudRate / 2U)) / BaudRate;
+    oversampling = UART_OVERSAMPLING_16;
+  }
+  if ((brr < 0x10U) || (brr > 0xFFFFU))
+  {
+    return HAL_ERROR;
+  }
+
+  /* let the last byte leave the shift register */
+  tickstart = HAL_GetTick();
+  while (__HAL_UART_GET_FLAG(&huart2, UART_FLAG_TC) == RESET)
+  {
+    if ((HAL_GetTick() - tickstart) > 100U)
+    {
+      return HAL_TIMEOUT;
+    }
+  }
+  __HAL_UART_DISABLE(&huart2);
+  MODIFY_REG(huart2.Instance->CR1, USART_CR1_OVER8, oversampling);
+  huart2.Instance->BRR = brr;
+  __HAL_UART_ENABLE(&huart2);
+  huart2.Init.BaudRate = BaudRate;
+  huart2.Init.OverSampling = oversampling;
+  return HAL_OK;
+}
 /* USER CODE END 1 */
 
 /**
@@ -41,7 +41,7 @@
 #include "wwdg.h"
 
 /* USER CODE BEGIN 0 */
-
+#include "McuPriority.h"
 /* USER CODE END 0 */
 
 WWDG_HandleTypeDef hwwdg;
@@ -51,10 +51,10 @@ void MX_WWDG_Init(void)
 {
 
   hwwdg.Instance = WWDG;
-  hwwdg.Init.Prescaler = WWDG_PRESCALER_1;
-  hwwdg.Init.Window = 64;
-  hwwdg.Init.Counter = 64;
-  hwwdg.Init.EWIMode = WWDG_EWI_DISABLE;
+  hwwdg.Init.Prescaler = WWDG_PRESCALER_8;
+  hwwdg.Init.Window = 127;
+  hwwdg.Init.Counter = 127;
+  hwwdg.Init.EWIMode = WWDG_EWI_ENABLE;
   if (HAL_WWDG_Init(&hwwdg) != HAL_OK)
   {
     _Error_Handler( __LINE__);
@@ -73,7 +73,11 @@ void HAL_WWDG_MspInit(WWDG_HandleTypeDef* wwdgHandle)
     /* WWDG clock enable */
     __HAL_RCC_WWDG_CLK_ENABLE();
   /* USER CODE BEGIN WWDG_MspInit 1 */
-
+    /* PCLK1 64 MHz / 4096 / 8 : one count every 0.512 ms, early wakeup after 32 ms without refresh.
+       The early wakeup has to preempt every other interrupt to report the stalled one */
+    __HAL_DBGMCU_FREEZE_WWDG();
+    HAL_NVIC_SetPriority(WWDG_IRQn, NVIC_PRIORITY_WATCHDOG, 0);
+    HAL_NVIC_EnableIRQ(WWDG_IRQn);
   /* USER CODE END WWDG_MspInit 1 */
   }
 }
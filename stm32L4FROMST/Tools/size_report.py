@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""
+Section size report of the firmware, with the delta against a stored baseline.
+
+The sizes are read from the section headers of the elf file : every allocated
+section is listed, flash is the sum of the sections stored in the image (code,
+constants and the initial values of .data and .sram2_data), ram the sum of the
+sections placed in SRAM1 or SRAM2.
+
+usage :
+    size_report.py build/stm32L4FROMST.elf --baseline Tools/size_baseline_debug.txt
+    size_report.py build/stm32L4FROMST.elf --baseline Tools/size_baseline_debug.txt --update
+
+The baselines Tools/size_baseline_<profile>.txt are not in the repository yet :
+they have to be generated with make size-baseline (make PROFILE=... size-baseline
+for each profile) on a machine with the arm-none-eabi toolchain, then committed.
+"""
+import argparse
+import os
+import struct
+import sys
+
+SHT_NOBITS = 8
+SHF_ALLOC = 0x2
+RAM_REGIONS = ((0x10000000, 0x10008000), (0x20000000, 0x20018000))  # SRAM2, SRAM1
+
+
+def read_sections(elf_path):
+    """Return [(name, address, size, in_image)] of the allocated sections of a 32 bits little endian elf."""
+    with open(elf_path, 'rb') as f:
+        elf = f.read()
+    if elf[:4] != b'\x7fELF' or elf[4] != 1 or elf[5] != 1:
+        raise ValueError('%s is not a 32 bits little endian elf file' % elf_path)
+    e_shoff, = struct.unpack_from('<I', elf, 0x20)
+    e_shentsize, e_shnum, e_shstrndx = struct.unpack_from('<HHH', elf, 0x2E)
+
+    def section(index):
+        # name, type, flags, addr, offset, size
+        return struct.unpack_from('<IIIIII', elf, e_shoff + index * e_shentsize)
+
+    strtab = section(e_shstrndx)
+    sections = []
+    for i in range(e_shnum):
+        sh = section(i)
+        if not sh[2] & SHF_ALLOC or sh[5] == 0:
+            continue
+        start = strtab[4] + sh[0]
+        name = elf[start:elf.index(b'\0', start)].decode()
+        sections.append((name, sh[3], sh[5], sh[1] != SHT_NOBITS))
+    return sections
+
+
+def summary(sections):
+    """Sizes by section name, with the flash and ram totals."""
+    sizes = {}
+    flash = ram = 0
+    for name, address, size, in_image in sections:
+        sizes[name] = sizes.get(name, 0) + size
+        if in_image:
+            flash += size
+        if any(low <= address < high for low, high in RAM_REGIONS):
+            ram += size
+    return sizes, {'flash': flash, 'ram': ram}
+
+
+def read_baseline(path):
+    baseline = {}
+    if path is None or not os.path.exists(path):
+        return None
+    with open(path) as f:
+        for line in f:
+            fields = line.split()
+            if len(fields) == 2 and not line.startswith('#'):
+                baseline[fields[0]] = int(fields[1])
+    return baseline
+
+
+def write_baseline(path, elf_path, sizes, totals):
+    with open(path, 'w') as f:
+        f.write('# section sizes of %s, written by Tools/size_report.py --update\n' % os.path.basename(elf_path))
+        for name, size in sizes.items():
+            f.write('%-24s %d\n' % (name, size))
+        for name, size in totals.items():
+            f.write('%-24s %d\n' % (name, size))
+
+
+def delta(size, base):
+    if base is None:
+        return '%10s' % 'new'
+    text = '%+10d' % (size - base)
+    if base != 0:
+        text += ' (%+.1f %%)' % (100.0 * (size - base) / base)
+    return text
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Report the section sizes of the firmware')
+    parser.add_argument('elf', help='firmware elf file')
+    parser.add_argument('--baseline', help='stored sizes to compare with')
+    parser.add_argument('--update', action='store_true', help='store the current sizes as the baseline')
+    args = parser.parse_args()
+
+    sizes, totals = summary(read_sections(args.elf))
+    if args.update:
+        if args.baseline is None:
+            parser.error('--update needs --baseline')
+        write_baseline(args.baseline, args.elf, sizes, totals)
+        print('baseline %s updated' % args.baseline)
+    baseline = read_baseline(args.baseline)
+
+    if baseline is None:
+        print('%-24s %10s' % ('section', 'size'))
+        for name, size in list(sizes.items()) + list(totals.items()):
+            print('%-24s %10d' % (name, size))
+        if args.baseline is not None:
+            print('no baseline in %s, store one with --update (make size-baseline) and commit it' % args.baseline)
+        return
+    print('%-24s %10s %10s %10s' % ('section', 'size', 'baseline', 'delta'))
+    for name, size in list(sizes.items()) + list(totals.items()):
+        base = baseline.get(name)
+        print('%-24s %10d %10s %s' % (name, size, '-' if base is None else base, delta(size, base)))
+    for name in baseline:
+        if name not in sizes and name not in totals:
+            print('%-24s %10s %10d %s' % (name, '-', baseline[name], delta(0, baseline[name])))
+
+
+if __name__ == '__main__':
+    try:
+        main()
+    except (OSError, ValueError) as error:
+        sys.exit('size_report.py: %s' % error)
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""
+Host decoder for the MMTRACE binary trace (see McuApi/McuTrace.h).
+
+The format strings are read from the non loaded .trace_fmt section of the
+elf file, the trace id of a frame is the offset of its string in the section.
+
+usage :
+    trace_decode.py build/stm32L4FROMST.elf capture.bin
+    trace_decode.py build/stm32L4FROMST.elf /dev/ttyACM0 --baud 115200   (needs pyserial)
+    cat capture.bin | trace_decode.py build/stm32L4FROMST.elf -
+"""
+import argparse
+import re
+import struct
+import sys
+
+FRAME_SYNC = 0xA5
+ID_TEXT = 0xFFFF
+MAX_ARGS = 8
+HEADER_SIZE = 8
+
+SPEC = re.compile(r'%([-+ #0]*)(\d+|\*)?(?:\.(\d+))?(hh|h|ll|l|j|z|t|L)?([diouxXcfFeEgGpsn%])')
+
+
+def read_trace_strings(elf_path):
+    """Return the raw bytes of the .trace_fmt section of a 32 bits little endian elf."""
+    with open(elf_path, 'rb') as f:
+        elf = f.read()
+    if elf[:4] != b'\x7fELF' or elf[4] != 1 or elf[5] != 1:
+        raise ValueError('%s is not a 32 bits little endian elf file' % elf_path)
+    e_shoff, = struct.unpack_from('<I', elf, 0x20)
+    e_shentsize, e_shnum, e_shstrndx = struct.unpack_from('<HHH', elf, 0x2E)
+
+    def section(index):
+        # name, type, flags, addr, offset, size
+        return struct.unpack_from('<IIIIII', elf, e_shoff + index * e_shentsize)
+
+    strtab = section(e_shstrndx)
+    for i in range(e_shnum):
+        sh = section(i)
+        start = strtab[4] + sh[0]
+        name = elf[start:elf.index(b'\0', start)].decode()
+        if name == '.trace_fmt':
+            return elf[sh[4]:sh[4] + sh[5]]
+    raise ValueError('no .trace_fmt section in %s, was it built with BINARY_TRACE = 1 ?' % elf_path)
+
+
+def c_format(fmt, args):
+    """printf-like formatting of the raw 32 bits arguments."""
+    out = []
+    pos = 0
+    args = list(args)
+    for m in SPEC.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, width, prec, _, conv = m.groups()
+        if conv == '%':
+            out.append('%')
+            continue
+        if width == '*':
+            width = str(args.pop(0)) if args else ''
+        raw = args.pop(0) if args else 0
+        spec = '%' + (flags or '') + (width or '') + ('.' + prec if prec is not None else '')
+        if conv in 'di':
+            value = raw - (1 << 32) if raw & 0x80000000 else raw
+            out.append((spec + 'd') % value)
+        elif conv in 'ouxX':
+            out.append((spec + ('d' if conv == 'u' else conv)) % raw)
+        elif conv == 'c':
+            out.append((spec + 'c') % chr(raw & 0xFF))
+        elif conv in 'fFeEgG':
+            out.append((spec + conv) % struct.unpack('<f', struct.pack('<I', raw))[0])
+        elif conv == 'p':
+            out.append('0x%08x' % raw)
+        else:  # %s can not be deferred, only the pointer is known
+            out.append('<str@0x%08x>' % raw)
+    out.append(fmt[pos:])
+    return ''.join(out)
+
+
+class Decoder:
+    def __init__(self, strings):
+        self.strings = strings
+        self.buf = bytearray()
+
+    def format_of(self, trace_id):
+        if trace_id >= len(self.strings) or (trace_id > 0 and self.strings[trace_id - 1] != 0):
+            return None  # an id always points to the start of a string
+        end = self.strings.index(b'\0', trace_id)
+        return self.strings[trace_id:end].decode('latin-1')
+
+    def feed(self, data):
+        """Consume raw bytes, yield (tick, text) for each complete frame."""
+        self.buf += data
+        while len(self.buf) >= HEADER_SIZE:
+            if self.buf[0] != FRAME_SYNC:
+                del self.buf[0]
+                continue
+            nargs = self.buf[1]
+            trace_id, tick = struct.unpack_from('<HI', self.buf, 2)
+            if trace_id == ID_TEXT:
+                length = nargs
+            else:
+                fmt = self.format_of(trace_id)
+                if fmt is None or nargs > MAX_ARGS:
+                    del self.buf[0]  # false sync, look for the next one
+                    continue
+                length = 4 * nargs
+            if len(self.buf) < HEADER_SIZE + length:
+                return
+            payload = bytes(self.buf[HEADER_SIZE:HEADER_SIZE + length])
+            del self.buf[:HEADER_SIZE + length]
+            if trace_id == ID_TEXT:
+                yield tick, payload.decode('latin-1')
+            else:
+                yield tick, c_format(fmt, struct.unpack('<%dI' % nargs, payload))
+
+
+def open_input(source, baud):
+    if source == '-':
+        return sys.stdin.buffer
+    if source.startswith('/dev/') or source.upper().startswith('COM'):
+        import serial
+        return serial.Serial(source, baud, timeout=0.1)
+    return open(source, 'rb')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode MMTRACE binary frames')
+    parser.add_argument('elf', help='firmware elf file holding the .trace_fmt section')
+    parser.add_argument('input', help='capture file, serial port or - for stdin')
+    parser.add_argument('--baud', type=int, default=115200, help='serial port baud rate')
+    args = parser.parse_args()
+
+    decoder = Decoder(read_trace_strings(args.elf))
+    stream = open_input(args.input, args.baud)
+    is_file = not hasattr(stream, 'in_waiting')
+    while True:
+        data = stream.read(4096) if is_file else stream.read(max(1, stream.in_waiting))
+        if not data:
+            if is_file:
+                break
+            continue
+        for tick, text in decoder.feed(data):
+            sys.stdout.write('[%10u] %s' % (tick, text if text.endswith('\n') else text + '\n'))
+        sys.stdout.flush()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,101 @@
+/*
+
+  __  __ _       _
+ |  \/  (_)     (_)
+ | \  / |_ _ __  _ _ __ ___   ___  _   _ ___  ___
+ | |\/| | | '_ \| | '_ ` _ \ / _ \| | | / __|/ _ \
+ | |  | | | | | | | | | | | | (_) | |_| \__ \  __/
+ |_|  |_|_|_| |_|_|_| |_| |_|\___/ \__,_|___/\___|
+
+
+Description       : Radio board wiring, one constexpr descriptor per board variant.
+                    The variant is chosen at build time, make BOARD=SX126X (default) or make BOARD=SX1276,
+                    and is known to the code as the Board type. The LORA_xxx pin macros of UserDefine.h
+                    are aliases of its members, CRYSTAL_ERROR, BOARD_DELAY_RX_SETTING_MS and
+                    PA_BOOST_CONNECTED stay plain numbers for the preprocessor and have to match it.
+                    The wiring is checked at compile time : no control line on a spi pin, no pin used
+                    twice, the two radio interrupts on different EXTI lines.
+                    To add a board, add a descriptor with the same members and a BOARD_xxx selection.
+
+License           : Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer        : Fabien Holin (SEMTECH)
+*/
+#ifndef USERBOARD_H
+#define USERBOARD_H
+#if defined ( MCU_POSIX )
+    #include "ClassPosix.h"
+#elif defined ( MCU_STM32L0 )
+    #include "ClassSTM32L0.h"
+#else
+    #include "ClassSTM32L4.h"
+#endif
+#include "UserDefine.h"
+
+/* sx126x mbed shield */
+struct BoardSx126x {
+    static constexpr PinName SpiMosi          = PA_7;
+    static constexpr PinName SpiMiso          = PA_6;
+    static constexpr PinName SpiSclk          = PA_5;
+    static constexpr PinName Cs               = PA_8;
+    static constexpr PinName Reset            = PA_0;
+    static constexpr PinName RadioIrq         = PB_4;  // DIO1 : TX/RX done, RX timeout
+    static constexpr PinName RxTimeoutIrq     = NC;    // on DIO1 too
+    static constexpr PinName Busy             = PB_3;
+    static constexpr int     CrystalError     = 30;    // for mcu clock with 3% accuracy (in case of clk is generated by internal rc for example)
+    static constexpr int     DelayRxSettingMs = 7;     // Time to configure board in rx mode
+    static constexpr int     PaBoostConnected = 0;
+};
+
+/* sx1276 mbed shield */
+struct BoardSx1276 {
+    static constexpr PinName SpiMosi          = D11;
+    static constexpr PinName SpiMiso          = D12;
+    static constexpr PinName SpiSclk          = D13;
+    static constexpr PinName Cs               = D10;
+    static constexpr PinName Reset            = A0;
+    static constexpr PinName RadioIrq         = D2;    // DIO0 : TX/RX done
+    static constexpr PinName RxTimeoutIrq     = D3;    // DIO1 : RX time out
+    static constexpr PinName Busy             = NC;
+    static constexpr int     CrystalError     = 20;    // Crystal error of the MCU to fine adjust the rx window for lorawan ( ex: set 3 for a crystal error = 0.3%)
+    static constexpr int     DelayRxSettingMs = 4;     // Delay introduce by the mcu Have to fine tune to adjust the window rx for lorawan
+    static constexpr int     PaBoostConnected = 0;     // Set to 1 to select Pa_boost outpin pin on the sx127x
+};
+
+#if defined ( BOARD_SX126X )
+    typedef BoardSx126x Board;
+#elif defined ( BOARD_SX1276 )
+    typedef BoardSx1276 Board;
+#else
+    #error "no radio board selected, see UserDefine.h"
+#endif
+
+/******************************************************************************/
+/*                           Compile time checks                              */
+/******************************************************************************/
+constexpr bool BoardOnSpi ( PinName pin ) {
+    return ( ( pin != NC ) && ( ( pin == Board::SpiMosi ) || ( pin == Board::SpiMiso ) || ( pin == Board::SpiSclk ) ) );
+}
+
+constexpr bool BoardSamePin ( PinName a, PinName b ) {
+    return ( ( a != NC ) && ( a == b ) );
+}
+
+static_assert ( ( Board::SpiMosi != Board::SpiMiso ) && ( Board::SpiMosi != Board::SpiSclk ) && ( Board::SpiMiso != Board::SpiSclk ),
+                "the spi pins have to be different" );
+static_assert ( ( Board::Cs != NC ) && ( Board::Reset != NC ) && ( Board::RadioIrq != NC ), "Cs, Reset and RadioIrq are mandatory" );
+static_assert ( !BoardOnSpi ( Board::Cs ) && !BoardOnSpi ( Board::Reset ) && !BoardOnSpi ( Board::RadioIrq ) &&
+                !BoardOnSpi ( Board::RxTimeoutIrq ) && !BoardOnSpi ( Board::Busy ), "a radio control line is wired on a spi pin" );
+static_assert ( !BoardSamePin ( Board::Cs, Board::Reset ) && !BoardSamePin ( Board::Cs, Board::RadioIrq ) &&
+                !BoardSamePin ( Board::Cs, Board::RxTimeoutIrq ) && !BoardSamePin ( Board::Cs, Board::Busy ) &&
+                !BoardSamePin ( Board::Reset, Board::RadioIrq ) && !BoardSamePin ( Board::Reset, Board::RxTimeoutIrq ) &&
+                !BoardSamePin ( Board::Reset, Board::Busy ) && !BoardSamePin ( Board::RadioIrq, Board::RxTimeoutIrq ) &&
+                !BoardSamePin ( Board::RadioIrq, Board::Busy ) && !BoardSamePin ( Board::RxTimeoutIrq, Board::Busy ),
+                "a pin is used twice by the radio" );
+static_assert ( ( Board::CrystalError == CRYSTAL_ERROR ) && ( Board::DelayRxSettingMs == BOARD_DELAY_RX_SETTING_MS ) &&
+                ( Board::PaBoostConnected == PA_BOOST_CONNECTED ), "UserDefine.h and the Board descriptor disagree" );
+// the EXTI lines are shared by the ports : PA_4 and PB_4 can't both interrupt
+static_assert ( ( Board::RxTimeoutIrq == NC ) || ( ( Board::RadioIrq & 0xF ) != ( Board::RxTimeoutIrq & 0xF ) ),
+                "RadioIrq and RxTimeoutIrq are on the same EXTI line" );
+
+#endif
@@ -17,7 +17,21 @@ Maintainer        : Fabien Holin (SEMTECH)
 */
 #ifndef USERDEFINE_H
 #define USERDEFINE_H
-#define SX126x_BOARD 1
+/* Radio board variant, make BOARD=SX1276 selects the other one, see UserBoard.h */
+#if !defined ( BOARD_SX126X ) && !defined ( BOARD_SX1276 )
+    #define BOARD_SX126X
+#endif
+/* the values that an #if may test, checked against the Board descriptor in UserBoard.h */
+#if defined ( BOARD_SX126X )
+    #define SX126x_BOARD              1
+    #define CRYSTAL_ERROR             30 // for mcu clock with 3% accuracy (in case of clk is generated by internal rc for example)
+    #define BOARD_DELAY_RX_SETTING_MS 7  // Time to configure board in rx mode
+    #define PA_BOOST_CONNECTED        0
+#else
+    #define CRYSTAL_ERROR             20 // Crystal error of the MCU to fine adjust the rx window for lorawan ( ex: set 3 for a crystal error = 0.3%)
+    #define BOARD_DELAY_RX_SETTING_MS 4  // Delay introduce by the mcu Have to fine tune to adjust the window rx for lorawan
+    #define PA_BOOST_CONNECTED        0  // Set to 1 to select Pa_boost outpin pin on the sx127x
+#endif
 
 
 /********************************************************************************/
@@ -26,32 +40,43 @@ Maintainer        : Fabien Holin (SEMTECH)
 #define DEBUG_TRACE    1      // Set to 1 to activate debug traces
 #define LOW_POWER_MODE 0      // Set to 1 to activate sleep mode , set to 0 to replace by wait functions (easier in debug mode) 
 #define DEBUG_TRACE_ENABLE 0  // Set to 1 to activate DebugTrace 
-
-#ifdef SX126x_BOARD
-/*SX126w BOARD specific */
-#define LORA_SPI_MOSI             PA_7
-#define LORA_SPI_MISO             PA_6
-#define LORA_SPI_SCLK             PA_5
-#define LORA_CS                   PA_8
-#define LORA_RESET                PA_0
-#define TX_RX_IT                  PB_4
-#define LORA_BUSY                 PB_3
-#define CRYSTAL_ERROR             30 // for mcu clock with 3% accuracy (in case of clk is generated by internal rc for example)
-#define BOARD_DELAY_RX_SETTING_MS 7 // Time to configure board in rx mode
-#define PA_BOOST_CONNECTED        0
-/*SX1276 BOARD specific */
+#define BINARY_TRACE   0      // Set to 1 to send MMTRACE as binary frames decoded on the host by Tools/trace_decode.py
+#define TRACE_RING_SIZE 1024  // Size in bytes of the trace ring buffer, have to be a power of 2
+#define UART_TRACE_BAUD 115200 // Debug uart rate at boot, change it at runtime with SetUartBaud or the console baud command
+#define CONSOLE_ENABLE 1      // Set to 1 to receive commands on the debug uart (DMA + idle line, see McuConsole.h)
+#define CONSOLE_RX_BUFFER_SIZE 256 // Size in bytes of the console DMA buffer, have to be a power of 2
+#define CONSOLE_LINE_MAX 64   // Longer command lines are discarded
+#define WWDG_ENABLE    1      // Set to 1 to start the WWDG, refreshed by the SysTick : its early wakeup saves a dump when interrupts stall for 32 ms
+#if defined ( MCU_STM32L0 ) // the Cortex-M0+ has no DWT cycle counter
+#define PROFILE_ENABLE 0
+#define ISR_STATS_ENABLE 0
 #else
-#define LORA_SPI_MOSI       D11
-#define LORA_SPI_MISO       D12
-#define LORA_SPI_SCLK       D13
-#define LORA_CS             D10
-#define LORA_RESET          A0
-#define TX_RX_IT            D2     // Interrupt TX/RX Done
-#define CRYSTAL_ERROR              20 // Crystal error of the MCU to fine adjust the rx window for lorawan ( ex: set 3 for a crystal error = 0.3%)
-#define BOARD_DELAY_RX_SETTING_MS  4  // Delay introduce by the mcu Have to fine tune to adjust the window rx for lorawan
-#define PA_BOOST_CONNECTED         0 //  Set to 1 to select Pa_boost outpin pin on the sx127x 
+#define PROFILE_ENABLE 1      // Set to 1 to measure the MMPROFILE scopes with the DWT cycle counter (console "prof")
+#define ISR_STATS_ENABLE 1    // Set to 1 to keep latency and duration histograms of the interrupt handlers (console "isr")
 #endif
-#define RX_TIMEOUT_IT       D3     // Interrupt RX TIME OUT 
+#define FAULT_DUMP_ENABLE 1   // Set to 1 to save a crash dump in SRAM2 and reset on a fault, reported at the next boot
+#define RAM_VECTOR_ENABLE 1   // Set to 1 to move the vector table to SRAM2, see McuVector.h
+#define POOL_64_BLOCKS   8    // Number of blocks of the Mcu layer memory pools, see McuPool.h
+#define POOL_256_BLOCKS  4
+#define POOL_2048_BLOCKS 1
+#define EVENT_LOOP_ENABLE 1   // Set to 1 to run the timer and radio callbacks from the main loop instead of the ISRs, see McuEvent.h
+
+/* Compile time log thresholds per module (LOG_LEVEL_NONE/ERROR/WARN/INFO/DEBUG/TRACE), see McuLog.h */
+#define LOG_LEVEL_MCU   LOG_LEVEL_INFO
+#define LOG_LEVEL_FLASH LOG_LEVEL_WARN
+#define LOG_LEVEL_RADIO LOG_LEVEL_INFO
+#define LOG_LEVEL_MAC   LOG_LEVEL_INFO
+#define LOG_LEVEL_APP   LOG_LEVEL_DEBUG
+
+/* Radio board wiring, aliases of the Board descriptor selected in UserBoard.h */
+#define LORA_SPI_MOSI             Board::SpiMosi
+#define LORA_SPI_MISO             Board::SpiMiso
+#define LORA_SPI_SCLK             Board::SpiSclk
+#define LORA_CS                   Board::Cs
+#define LORA_RESET                Board::Reset
+#define TX_RX_IT                  Board::RadioIrq     // Interrupt TX/RX Done
+#define RX_TIMEOUT_IT             Board::RxTimeoutIrq // Interrupt RX TIME OUT, NC when on TX_RX_IT
+#define LORA_BUSY                 Board::Busy
 #define FLASH_UPDATE_PERIOD 32      // The Lorawan context is stored in memory with a period equal to FLASH_UPDATE_PERIOD packets transmitted
 #define USERFLASHADRESS 0x807E000U   // start flash adress to store lorawan context
 
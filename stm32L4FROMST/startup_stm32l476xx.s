@@ -106,6 +106,42 @@ LoopFillZerobss:
 	cmp	r2, r3
 	bcc	FillZerobss
 
+/* Copy the SRAM2 code and data initializers from flash, see McuApi/McuSections.h */
+	ldr	r0, =_ssram2
+	ldr	r1, =_esram2
+	ldr	r2, =_sisram2
+	b	LoopCopySram2Init
+CopySram2Init:
+	ldr	r3, [r2], #4
+	str	r3, [r0], #4
+
+LoopCopySram2Init:
+	cmp	r0, r1
+	bcc	CopySram2Init
+/* Zero fill the SRAM2 bss segment, .sram2_noinit is left untouched */
+	ldr	r2, =_ssram2_bss
+	ldr	r1, =_esram2_bss
+	movs	r3, #0
+	b	LoopFillZeroSram2
+FillZeroSram2:
+	str	r3, [r2], #4
+
+LoopFillZeroSram2:
+	cmp	r2, r1
+	bcc	FillZeroSram2
+
+/* Paint the heap and stack area, see STACK_PAINT_PATTERN in McuApi/McuMemory.h */
+	ldr	r2, =_end
+	ldr	r3, =0xA5A5A5A5
+	mov	r1, sp
+	b	LoopPaintStack
+PaintStack:
+	str	r3, [r2], #4
+
+LoopPaintStack:
+	cmp	r2, r1
+	bcc	PaintStack
+
 /* Call the clock system intitialization function.*/
     bl  SystemInit
 /* Call static constructors */